@@ -0,0 +1,56 @@
+#include "codec/CodecStream.hpp"
+
+#include "Buffer.hpp"
+#include "Logger.hpp"
+#include "TcpConnection.hpp"
+
+namespace
+{
+template <typename Codec, typename Message>
+AsyncGenerator<Message> decodeStream(std::shared_ptr<TcpConnection> conn, size_t readSize, const char *codecName)
+{
+    Buffer input;
+    Message message;
+    while (true)
+    {
+        // 先产出缓冲区中所有完整的消息：流水线请求不需要再读 socket
+        typename Codec::DecodeResult result;
+        while ((result = Codec::decode(&input, message)) == Codec::DecodeResult::kComplete)
+        {
+            co_yield message;
+        }
+        if (result == Codec::DecodeResult::kError)
+        {
+            LOG_WARN("{} stream: decode error, conn={}", codecName, conn->getName());
+            co_return;
+        }
+
+        // 请求边界上（没有读了一半的消息）：服务器正在排空时结束，否则标记这次读只是在等待下一个请求
+        bool atBoundary = input.readableBytes() == 0;
+        if (atBoundary && conn->isDraining())
+        {
+            co_return;
+        }
+        conn->setAwaitingRequest(atBoundary);
+
+        // 数据不足：直接读入解码缓冲区的可写区域
+        input.ensureWritableBytes(readSize);
+        int n = co_await conn->asyncRead(input.writeBeginAddr(), input.writeableBytes(), readSize);
+        if (n <= 0)
+        {
+            co_return;
+        }
+        input.hasWritten(static_cast<size_t>(n));
+    }
+}
+} // namespace
+
+AsyncGenerator<HttpRequest> httpRequests(std::shared_ptr<TcpConnection> conn, size_t readSize)
+{
+    return decodeStream<HttpCodec, HttpRequest>(std::move(conn), readSize, "HttpCodec");
+}
+
+AsyncGenerator<RpcMessage> rpcMessages(std::shared_ptr<TcpConnection> conn, size_t readSize)
+{
+    return decodeStream<RpcCodec, RpcMessage>(std::move(conn), readSize, "RpcCodec");
+}
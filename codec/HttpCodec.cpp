@@ -113,25 +113,33 @@ HttpCodec::DecodeResult HttpCodec::decode(Buffer *buf, HttpRequest &outRequest)
     return DecodeResult::kComplete;
 }
 
-void HttpCodec::encode(Buffer *buf, const HttpResponse &response)
+void HttpCodec::encode(Buffer *buf, const HttpResponse &response, std::pmr::memory_resource *mr)
 {
-    // 预分配大致空间，避免多次 reallocation
-    std::string respStr;
-    respStr.reserve(256 + response.body.size());
+    // 只拼接头部，包体直接追加到 buffer，不再复制进临时字符串
+    std::pmr::string header(mr);
+    header.reserve(256);
+    char num[24];
 
     // 状态行
-    respStr += "HTTP/1.1 " + std::to_string(response.statusCode) + " " + response.statusMessage + "\r\n";
+    header += "HTTP/1.1 ";
+    header.append(num, std::to_chars(num, num + sizeof(num), response.statusCode).ptr);
+    header += ' ';
+    header += response.statusMessage;
+    header += "\r\n";
 
     // 头部
-    respStr += "Content-Type: " + response.contentType + "\r\n";
-    respStr += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
-    respStr += response.keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    header += "Content-Type: ";
+    header += response.contentType;
+    header += "\r\nContent-Length: ";
+    header.append(num, std::to_chars(num, num + sizeof(num), response.body.size()).ptr);
+    header += "\r\n";
+    header += response.keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
 
     // 空行
-    respStr += "\r\n";
+    header += "\r\n";
 
     // 追加到 buffer (header + body)
-    buf->append(respStr);
+    buf->append(header.data(), header.size());
     buf->append(response.body);
 }
 
@@ -45,6 +45,8 @@ class Acceptor
     }
     // 监听本地端口
     void listen();
+    // 停止监听：取消在途的 accept 并关闭监听 Socket，新连接由内核拒绝（或由同端口的新进程接收）
+    void stop();
 
   private:
     void handleRead(int res); // 监听Socket可读事件的回调函数，接受新连接
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MemoryPool.hpp"
+
+constexpr size_t ALLOC_PROFILE_CLASS_NUM = MEMORY_POOL_NUM + 1; // 各大小类别 + 超过 MAX_SLOT_SIZE 的 malloc
+constexpr size_t ALLOC_PROFILE_MAX_FRAMES = 16;                   // 每个采样记录的调用栈深度
+constexpr size_t ALLOC_PROFILE_FILTER_SIZE = 1 << 15;             // 释放路径上过滤未采样指针的计数表大小
+
+/**
+ * HashBucket 的分配剖析（运行时开关，关闭时每次分配/释放只多一次 relaxed 原子读）
+ *
+ * - 每个大小类别统计分配/释放次数，差值即用户实际持有的槽数（不含线程本地缓存），并记录其峰值；
+ * - 每个线程每 sampleInterval 次分配采样一次，用 backtrace() 记录调用栈，槽释放时删除记录，
+ *   剩下的采样按调用栈聚合就是"谁还拿着内存池的内存"，采样字节数乘以间隔即为该调用点持有量的估计；
+ * - 释放路径先查一张按指针哈希的计数表，绝大多数未采样的指针不加锁直接跳过；
+ * - 计数从 enable 开始：开启前分配、开启后释放的槽会让 live 偏小（可能为负），定位泄漏应在启动时开启；
+ * - 调用栈的前一两帧是 HashBucket::useMemory/recordAllocation，之后才是调用方；
+ * - 调用栈符号化依赖 backtrace_symbols，可执行文件未加 -rdynamic 时只有模块偏移，需用 addr2line 解析。
+ *
+ *   AllocProfiler::enable(4096);
+ *   AllocProfiler::Report report = AllocProfiler::report(20); // 持有最多的 20 个调用点
+ */
+class AllocProfiler
+{
+  public:
+    struct ClassStats
+    {
+        size_t slotSize = 0;        // 槽大小，最后一项（malloc）为 0
+        uint64_t allocations = 0;   // 分配次数
+        uint64_t deallocations = 0; // 释放次数
+        int64_t live = 0;           // 当前持有数
+        int64_t highWater = 0;      // 持有数峰值
+        int64_t liveBytes = 0;      // 当前持有字节数（按槽大小计，malloc 按实际大小）
+    };
+
+    // 按调用栈聚合的存活采样
+    struct Site
+    {
+        size_t samples = 0;                     // 存活的采样数
+        size_t sampledBytes = 0;                // 采样分配的字节数之和
+        size_t estimatedBytes = 0;              // 估计持有量：sampledBytes * sampleInterval
+        std::chrono::milliseconds oldestAge{0}; // 最早一个采样至今的时间，长期存活的调用点是泄漏嫌疑
+        std::vector<std::string> frames;        // 符号化后的调用栈，由近及远
+    };
+
+    struct Report
+    {
+        bool enabled = false;
+        size_t sampleInterval = 0;
+        std::array<ClassStats, ALLOC_PROFILE_CLASS_NUM> classes{};
+        size_t liveSamples = 0;    // 存活的采样记录数
+        uint64_t totalSamples = 0; // 开启以来的采样次数
+        std::vector<Site> sites;   // 按 estimatedBytes 降序
+    };
+
+    // 开启剖析；sampleInterval 为 0 时只统计计数，不采样调用栈。可在运行中调用以修改采样间隔
+    static void enable(size_t sampleInterval);
+    // 关闭剖析并丢弃采样记录（计数保留，供关闭后查看）
+    static void disable();
+    static bool enabled() noexcept
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // HashBucket 的分配/释放钩子，index 为大小类别，超过 MAX_SLOT_SIZE 时为 MEMORY_POOL_NUM
+    static void recordAllocation(void *p, size_t size, size_t index);
+    static void recordDeallocation(void *p, size_t size, size_t index);
+
+    // 汇总当前状态，sites 只保留持有量最大的 maxSites 个调用点
+    static Report report(size_t maxSites);
+    // 把各类别的峰值重置为当前持有数，用于观察下一个时间窗口的峰值
+    static void resetHighWater();
+
+  private:
+    struct alignas(64) ClassCounters
+    {
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> deallocations{0};
+        std::atomic<int64_t> highWater{0};
+        std::atomic<int64_t> liveBytes{0}; // 仅 malloc 类别使用，大小类别按槽大小计算
+    };
+
+    static void sample(void *p, size_t size); // 记录调用栈
+    static void forget(void *p);
+    static size_t filterIndex(void *p) noexcept;
+
+    static std::atomic<bool> enabled_;
+    static std::atomic<size_t> sampleInterval_;
+    static std::atomic<uint64_t> totalSamples_;
+    static std::array<ClassCounters, ALLOC_PROFILE_CLASS_NUM> counters_;
+    static std::array<std::atomic<uint32_t>, ALLOC_PROFILE_FILTER_SIZE> filter_; // 各哈希桶中的存活采样数
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <fcntl.h>
+#include <liburing.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <utility>
+
+#include "CoroutineTask.hpp"
+#include "EventLoop.hpp"
+#include "IoContext.hpp"
+
+/**
+ * @file AsyncFile.hpp
+ * 基于 io_uring 的异步文件 IO：打开、读写、statx、fsync 都不阻塞 EventLoop
+ *
+ *   int fd = co_await asyncOpenat(loop, AT_FDCWD, "model.bin", O_RDONLY | O_DIRECT);
+ *   AsyncFile file(loop, fd, true);
+ *   struct statx st;
+ *   co_await file.statx(&st);
+ *   FileBufferView view;
+ *   int n = co_await file.readAligned(offset, len, view); // O_DIRECT 下 offset/len 不必对齐
+ *   ...                                                    // 使用 view.data[0, n)
+ *   loop->returnRegisteredBuffer(view.idx);
+ *
+ * - 所有 Awaitable 必须在 loop 线程中 co_await，返回值为内核的结果（字节数/fd，失败为负的错误码）；
+ * - readFixed/writeFixed 使用 Loop 的已注册缓冲区（IORING_OP_READ_FIXED/WRITE_FIXED），省去每次请求的页固定；
+ * - 已注册缓冲区按页对齐分配，可以直接用于 O_DIRECT，但单次请求不超过一个缓冲区的大小；
+ * - readBatch 把多个读请求放在同一轮提交，全部完成后协程恢复一次。
+ */
+
+// 单个文件请求的 Awaitable：挂起时由 Prep 填写 SQE，完成后返回 CQE 的结果
+template <typename Prep>
+class FileIoAwaitable
+{
+  public:
+    FileIoAwaitable(EventLoop *loop, Prep prep) : loop_(loop), prep_(std::move(prep)), context_(IoType::Read, -1) {}
+    // 禁用拷贝和赋值
+    FileIoAwaitable(const FileIoAwaitable &) = delete;
+    FileIoAwaitable &operator=(const FileIoAwaitable &) = delete;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+    // SQ 已满时不挂起，以 -EBUSY 继续
+    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&loop_->ring_);
+        if (!sqe)
+        {
+            context_.result_ = -EBUSY;
+            return false;
+        }
+        prep_(sqe);
+        io_uring_sqe_set_data(sqe, &context_);
+        context_.coro_handle = handle;
+        return true;
+    }
+    int await_resume() const noexcept
+    {
+        return context_.result_;
+    }
+    // 取消在途的请求（when_any 取消落败者时调用），协程随后以 -ECANCELED 恢复
+    void cancel() noexcept
+    {
+        loop_->cancelIo(&context_);
+    }
+
+  private:
+    EventLoop *loop_;
+    Prep prep_;          // 填写 SQE 的函数对象，其中引用的路径等参数随 Awaitable 一起存活到请求完成
+    IoContext context_;  // 请求的上下文（协程模式）
+};
+
+// readBatch 的单个读请求
+struct FileReadOp
+{
+    off_t offset = 0;     // 文件偏移
+    void *buf = nullptr;  // 目标缓冲区，bufIdx >= 0 时必须位于该已注册缓冲区内
+    size_t len = 0;       // 读取长度
+    int bufIdx = -1;      // 已注册缓冲区索引，-1 表示普通缓冲区
+    int result = 0;       // 完成后回填：读到的字节数或负的错误码
+};
+
+// 批量读：所有请求在同一轮提交，最后一个完成时恢复协程，返回成功的请求数
+class FileReadBatchAwaitable
+{
+  public:
+    FileReadBatchAwaitable(EventLoop *loop, int fd, std::span<FileReadOp> ops) : loop_(loop), fd_(fd), ops_(ops) {}
+    // 禁用拷贝和赋值
+    FileReadBatchAwaitable(const FileReadBatchAwaitable &) = delete;
+    FileReadBatchAwaitable &operator=(const FileReadBatchAwaitable &) = delete;
+
+    bool await_ready() const noexcept
+    {
+        return ops_.empty();
+    }
+    bool await_suspend(std::coroutine_handle<> handle);
+    int await_resume() const noexcept;
+    // 取消尚未完成的请求
+    void cancel() noexcept;
+
+  private:
+    // 每个请求一个上下文：CQE 只能通过 user_data 区分是哪个请求完成
+    struct Slot
+    {
+        Slot() : context(IoType::Read, -1) {}
+        IoContext context;
+        bool done = false;
+    };
+
+    EventLoop *loop_;
+    int fd_;
+    std::span<FileReadOp> ops_;
+    std::unique_ptr<Slot[]> slots_;  // 与 ops_ 一一对应
+    size_t remaining_ = 0;           // 尚未完成的请求数
+    std::coroutine_handle<> handle_; // 等待全部完成的协程
+};
+
+// O_DIRECT 对齐读的结果：数据位于已注册缓冲区 idx 中，使用完毕后由调用者归还
+struct FileBufferView
+{
+    int idx = -1;               // 已注册缓冲区索引
+    const char *data = nullptr; // 请求的数据在缓冲区中的起始位置
+    size_t size = 0;            // 有效数据长度（文件末尾时可能小于请求长度）
+};
+
+class AsyncFile
+{
+  public:
+    // O_DIRECT 的偏移/长度/内存对齐粒度（覆盖常见设备的逻辑块大小）
+    static constexpr size_t kDirectAlignment = 4096;
+
+    // 接管已打开的 fd，direct 表示 fd 以 O_DIRECT 打开
+    AsyncFile(EventLoop *loop, int fd, bool direct = false) : loop_(loop), fd_(fd), direct_(direct) {}
+    AsyncFile(AsyncFile &&other) noexcept
+        : loop_(other.loop_), fd_(std::exchange(other.fd_, -1)), direct_(other.direct_)
+    {
+    }
+    AsyncFile &operator=(AsyncFile &&other) noexcept;
+    // 禁用拷贝
+    AsyncFile(const AsyncFile &) = delete;
+    AsyncFile &operator=(const AsyncFile &) = delete;
+    // 仍然打开时同步关闭 fd（关闭不会阻塞在设备 IO 上）
+    ~AsyncFile();
+
+    bool isOpen() const noexcept
+    {
+        return fd_ >= 0;
+    }
+    int fd() const noexcept
+    {
+        return fd_;
+    }
+    bool isDirect() const noexcept
+    {
+        return direct_;
+    }
+    void close();
+
+    // 读写已注册缓冲区 idx 的前 len 字节（IORING_OP_READ_FIXED/WRITE_FIXED）
+    auto readFixed(off_t offset, int idx, size_t len)
+    {
+        void *buf = loop_->getRegisteredBuffer(idx);
+        return FileIoAwaitable(loop_, [fd = fd_, buf, len, offset, idx](struct io_uring_sqe *sqe) {
+            io_uring_prep_read_fixed(sqe, fd, buf, static_cast<unsigned>(len), static_cast<__u64>(offset), idx);
+        });
+    }
+    auto writeFixed(off_t offset, int idx, size_t len)
+    {
+        const void *buf = loop_->getRegisteredBuffer(idx);
+        return FileIoAwaitable(loop_, [fd = fd_, buf, len, offset, idx](struct io_uring_sqe *sqe) {
+            io_uring_prep_write_fixed(sqe, fd, buf, static_cast<unsigned>(len), static_cast<__u64>(offset), idx);
+        });
+    }
+    // 读写普通缓冲区（O_DIRECT 下 buf 需要按 kDirectAlignment 对齐）
+    auto read(off_t offset, void *buf, size_t len)
+    {
+        return FileIoAwaitable(loop_, [fd = fd_, buf, len, offset](struct io_uring_sqe *sqe) {
+            io_uring_prep_read(sqe, fd, buf, static_cast<unsigned>(len), static_cast<__u64>(offset));
+        });
+    }
+    auto write(off_t offset, const void *buf, size_t len)
+    {
+        return FileIoAwaitable(loop_, [fd = fd_, buf, len, offset](struct io_uring_sqe *sqe) {
+            io_uring_prep_write(sqe, fd, buf, static_cast<unsigned>(len), static_cast<__u64>(offset));
+        });
+    }
+    // dataOnly 为 true 时等价于 fdatasync
+    auto fsync(bool dataOnly = false)
+    {
+        return FileIoAwaitable(loop_, [fd = fd_, dataOnly](struct io_uring_sqe *sqe) {
+            io_uring_prep_fsync(sqe, fd, dataOnly ? IORING_FSYNC_DATASYNC : 0);
+        });
+    }
+    auto statx(struct statx *out, unsigned mask = STATX_BASIC_STATS)
+    {
+        return FileIoAwaitable(loop_, [fd = fd_, out, mask](struct io_uring_sqe *sqe) {
+            io_uring_prep_statx(sqe, fd, "", AT_EMPTY_PATH, mask, out);
+        });
+    }
+
+    // 批量读：ops 由调用者持有，存活到 co_await 结束
+    FileReadBatchAwaitable readBatch(std::span<FileReadOp> ops)
+    {
+        return FileReadBatchAwaitable(loop_, fd_, ops);
+    }
+
+    // 对齐读：把 [offset, offset + len) 向外扩展到 kDirectAlignment 的整数倍，读入一个空闲的已注册缓冲区
+    // 返回有效数据长度（失败为负的错误码），成功时 view 指向缓冲区中请求的数据，调用者用完后归还 view.idx
+    // 扩展后的长度超过已注册缓冲区大小时返回 -EINVAL，没有空闲缓冲区时返回 -ENOBUFS
+    Task<int> readAligned(off_t offset, size_t len, FileBufferView &view);
+
+  private:
+    EventLoop *loop_;
+    int fd_;
+    bool direct_;
+};
+
+// co_await asyncOpenat(loop, dirfd, path, flags, mode)：返回打开的 fd 或负的错误码
+inline auto asyncOpenat(EventLoop *loop, int dirfd, std::string path, int flags, mode_t mode = 0644)
+{
+    return FileIoAwaitable(loop, [dirfd, path = std::move(path), flags, mode](struct io_uring_sqe *sqe) {
+        io_uring_prep_openat(sqe, dirfd, path.c_str(), flags, mode);
+    });
+}
+
+// co_await asyncStatx(loop, dirfd, path, flags, mask, out)：结果写入 out，返回 0 或负的错误码
+inline auto asyncStatx(EventLoop *loop, int dirfd, std::string path, int flags, unsigned mask, struct statx *out)
+{
+    return FileIoAwaitable(loop, [dirfd, path = std::move(path), flags, mask, out](struct io_uring_sqe *sqe) {
+        io_uring_prep_statx(sqe, dirfd, path.c_str(), flags, mask, out);
+    });
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "FramePool.hpp"
+
+template <typename T>
+class AsyncGenerator;
+
+namespace detail
+{
+template <typename T>
+class AsyncGeneratorPromise
+{
+  public:
+    using value_type = std::remove_reference_t<T>;
+    using pointer = value_type *;
+
+    AsyncGenerator<T> get_return_object() noexcept;
+
+    std::suspend_always initial_suspend() const noexcept
+    {
+        return {};
+    }
+
+    // co_yield 与结束时都对称转移回等待 next() 的消费协程
+    struct YieldAwaiter
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<AsyncGeneratorPromise> handle) noexcept
+        {
+            return handle.promise().consumer_;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    // 只保存被 co_yield 对象的地址：左值是生成器内复用的对象，右值临时对象在挂起期间同样存活，都不拷贝
+    YieldAwaiter yield_value(value_type &value) noexcept
+    {
+        current_ = std::addressof(value);
+        return {};
+    }
+    YieldAwaiter yield_value(value_type &&value) noexcept
+    {
+        current_ = std::addressof(value);
+        return {};
+    }
+
+    YieldAwaiter final_suspend() noexcept
+    {
+        current_ = nullptr;
+        return {};
+    }
+
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept
+    {
+        exception_ = std::current_exception();
+    }
+
+    // 协程帧从当前线程（EventLoop）的帧池分配
+    static void *operator new(size_t size)
+    {
+        return FramePool::allocate(size);
+    }
+    static void operator delete(void *p, size_t size)
+    {
+        FramePool::deallocate(p, size);
+    }
+
+  private:
+    friend class AsyncGenerator<T>;
+
+    std::coroutine_handle<> consumer_; // 等待下一个值的消费协程
+    pointer current_ = nullptr;        // 当前产出值的地址，生成器结束时为空
+    std::exception_ptr exception_;     // 生成器体抛出的异常，在消费方的 next() 处重新抛出
+};
+} // namespace detail
+
+/**
+ * @brief 异步生成器：协程体内既可以 co_await IO，也可以 co_yield 产出值
+ *
+ * C++20 没有 for co_await，消费方的写法为：
+ *   auto requests = httpRequests(conn);
+ *   while (HttpRequest *req = co_await requests.next())
+ *   {
+ *       ...  // *req 在下一次调用 next() 之前有效
+ *   }
+ * - 惰性启动：第一次 next() 时才开始执行，每次 next() 运行到下一个 co_yield 或结束；
+ * - 生产方与消费方之间以对称转移切换，不经过 EventLoop；
+ * - 产出值不拷贝：next() 返回指向生成器内对象的指针，生成器结束时返回 nullptr；
+ * - 生成器体内的异常在 next() 处重新抛出；AsyncGenerator 独占协程帧，析构时销毁（可在任意挂起点提前放弃）。
+ */
+template <typename T>
+class AsyncGenerator
+{
+  public:
+    using promise_type = detail::AsyncGeneratorPromise<T>;
+    using pointer = typename promise_type::pointer;
+
+    explicit AsyncGenerator(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+    AsyncGenerator(AsyncGenerator &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    AsyncGenerator &operator=(AsyncGenerator &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    // 禁用拷贝和赋值
+    AsyncGenerator(const AsyncGenerator &) = delete;
+    AsyncGenerator &operator=(const AsyncGenerator &) = delete;
+
+    ~AsyncGenerator()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    class NextAwaiter
+    {
+      public:
+        explicit NextAwaiter(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+        bool await_ready() const noexcept
+        {
+            return !handle_ || handle_.done();
+        }
+        // 记录消费方后直接转移到生成器执行，生成器 co_yield 或结束时再转移回来
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept
+        {
+            handle_.promise().consumer_ = consumer;
+            return handle_;
+        }
+        pointer await_resume()
+        {
+            if (!handle_)
+            {
+                return nullptr;
+            }
+            promise_type &promise = handle_.promise();
+            if (promise.exception_)
+            {
+                std::rethrow_exception(std::exchange(promise.exception_, nullptr));
+            }
+            return handle_.done() ? nullptr : promise.current_;
+        }
+
+      private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    // 取下一个值：返回指向产出值的指针，生成器结束时返回 nullptr
+    NextAwaiter next() noexcept
+    {
+        return NextAwaiter(handle_);
+    }
+
+    bool done() const noexcept
+    {
+        return !handle_ || handle_.done();
+    }
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail
+{
+template <typename T>
+inline AsyncGenerator<T> AsyncGeneratorPromise<T>::get_return_object() noexcept
+{
+    return AsyncGenerator<T>{std::coroutine_handle<AsyncGeneratorPromise<T>>::from_promise(*this)};
+}
+} // namespace detail
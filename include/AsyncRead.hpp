@@ -2,6 +2,7 @@
 #include <coroutine>
 #include <cstddef>
 
+#include "Deadline.hpp"
 #include "MemoryPool.hpp"
 
 class TcpConnection;
@@ -13,13 +14,15 @@ class AsyncReadAwaitable
     AsyncReadAwaitable(const AsyncReadAwaitable &) = delete;
     AsyncReadAwaitable &operator=(const AsyncReadAwaitable &) = delete;
     // 固定缓冲区版本，减少内存映射开销
-    AsyncReadAwaitable(TcpConnection *conn, std::size_t nbytes)
-        : conn_(conn), nbytes_(nbytes), userBuf_(nullptr), userBufCap_(0)
+    // deadline 不为 kNoDeadline 时读请求链接一个绝对时间的 LINK_TIMEOUT，到期未读到数据返回 kDeadlineExceeded
+    AsyncReadAwaitable(TcpConnection *conn, std::size_t nbytes, Deadline deadline = kNoDeadline)
+        : conn_(conn), nbytes_(nbytes), userBuf_(nullptr), userBufCap_(0), deadline_(deadline)
     {
     }
     // 重载构造函数，支持用户提供缓冲区，将数据读入用户缓冲区
-    AsyncReadAwaitable(TcpConnection *conn, char *userBuf, std::size_t userBufCap, std::size_t nbytes)
-        : conn_(conn), nbytes_(nbytes), userBuf_(userBuf), userBufCap_(userBufCap)
+    AsyncReadAwaitable(TcpConnection *conn, char *userBuf, std::size_t userBufCap, std::size_t nbytes,
+                       Deadline deadline = kNoDeadline)
+        : conn_(conn), nbytes_(nbytes), userBuf_(userBuf), userBufCap_(userBufCap), deadline_(deadline)
     {
     }
     bool await_ready() const noexcept
@@ -28,6 +31,8 @@ class AsyncReadAwaitable
     }
     void await_suspend(std::coroutine_handle<> handle) noexcept;
     int await_resume() const noexcept;
+    // 取消在途的读请求（when_any 取消落败者时调用），协程随后以 -ECANCELED 恢复
+    void cancel() noexcept;
     ~AsyncReadAwaitable() = default;
 
     // 重载new/delete，接入内存池
@@ -45,4 +50,5 @@ class AsyncReadAwaitable
     std::size_t nbytes_;
     char *userBuf_;
     std::size_t userBufCap_;
+    Deadline deadline_; // 本次读的截止时间
 };
\ No newline at end of file
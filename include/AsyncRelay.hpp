@@ -0,0 +1,50 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+
+#include "MemoryPool.hpp"
+
+class TcpConnection;
+
+// 链接式中继的 Awaitable：读段与写段两个 SQE 通过 IOSQE_IO_LINK 链接，在同一次提交中进入内核
+// 协程在写段完成（整条链结束）后才恢复，中间不再经过用户态
+class AsyncRelayAwaitable
+{
+  public:
+    // 禁用拷贝和赋值
+    AsyncRelayAwaitable(const AsyncRelayAwaitable &) = delete;
+    AsyncRelayAwaitable &operator=(const AsyncRelayAwaitable &) = delete;
+    // 回显模式：read_fixed 读入已注册缓冲区，链接 write_fixed 把同一缓冲区写回本连接
+    AsyncRelayAwaitable(TcpConnection *conn, std::size_t len) : conn_(conn), dstFd_(-1), len_(len)
+    {
+    }
+    // Splice 中继模式：socket -> 管道 -> dstFd，两段 splice 链接提交
+    AsyncRelayAwaitable(TcpConnection *conn, int dstFd, std::size_t len) : conn_(conn), dstFd_(dstFd), len_(len)
+    {
+    }
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+    // 提交失败时不挂起，错误码在 await_resume 中返回
+    bool await_suspend(std::coroutine_handle<> handle) noexcept;
+    int await_resume() const noexcept;
+    // 取消在途的中继（读段被取消后链接的写段随之取消），协程随后以 -ECANCELED 恢复
+    void cancel() noexcept;
+    ~AsyncRelayAwaitable() = default;
+
+    // 重载new/delete，接入内存池
+    static void *operator new(size_t size)
+    {
+        return HashBucket::useMemory(size);
+    }
+    static void operator delete(void *p, size_t size)
+    {
+        HashBucket::freeMemory(p, size);
+    }
+
+  private:
+    TcpConnection *conn_;
+    int dstFd_; // Splice 目标 fd，-1 表示回显模式
+    std::size_t len_;
+};
@@ -12,14 +12,9 @@ class AsyncSleepAwaitable
   public:
     template <typename Rep, typename Period>
     AsyncSleepAwaitable(EventLoop *loop, std::chrono::duration<Rep, Period> duration)
-        : loop_(loop), timeoutContext_(IoType::Timeout, -1) // 超时事件不关联文件描述符，使用-1占位
+        : loop_(loop), duration_(std::chrono::duration_cast<std::chrono::nanoseconds>(duration)),
+          timeoutContext_(IoType::Timeout, -1) // 超时事件不关联文件描述符，使用-1占位
     {
-        // 将chrono转换为io_uring所需的__kernel_timespec 结构时间格式.
-        auto secs = std::chrono::duration_cast<std::chrono::seconds>(duration);
-        auto nsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(duration - secs);
-
-        ts_.tv_sec = secs.count();
-        ts_.tv_nsec = nsecs.count();
     }
 
     bool await_ready() const noexcept
@@ -27,7 +22,7 @@ class AsyncSleepAwaitable
         return false; // 总是异步等待
     }
 
-    // 协程挂起时提交超时任务给io_uring
+    // 协程挂起时计算绝对到期时间，交给 Loop 暂存，在本轮批处理结束时随其他请求一起提交
     void await_suspend(std::coroutine_handle<> handle);
 
     void await_resume() const noexcept
@@ -35,6 +30,9 @@ class AsyncSleepAwaitable
         // 超时事件完成后恢复协程，无需返回值
     }
 
+    // 提前结束等待（when_any 取消落败者时调用），协程随后立即恢复
+    void cancel() noexcept;
+
     ~AsyncSleepAwaitable() = default;
 
     // 重载new/delete，接入内存池
@@ -48,7 +46,8 @@ class AsyncSleepAwaitable
     }
 
   private:
-    EventLoop *loop_;             // 关联的事件循环，用于提交超时任务
-    struct __kernel_timespec ts_; // io_uring使用的时间格式
-    IoContext timeoutContext_;    // 超时事件的上下文
+    EventLoop *loop_;                    // 关联的事件循环，用于提交超时任务
+    std::chrono::nanoseconds duration_;  // 睡眠时长，挂起时才换算为绝对时间
+    struct __kernel_timespec ts_{};      // io_uring使用的时间格式（绝对时间）
+    IoContext timeoutContext_;           // 超时事件的上下文
 };
\ No newline at end of file
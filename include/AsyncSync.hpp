@@ -0,0 +1,244 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @file AsyncSync.hpp
+ * 协程同步原语：AsyncMutex、AsyncSemaphore
+ *
+ * 仅限同一个 EventLoop 线程内的协程之间使用：不使用原子操作与系统锁，等待者以侵入式链表
+ * 挂在 Awaiter（位于协程帧中）上，不产生额外分配。
+ * 释放时所有权/许可直接移交给最早的等待者并在当前调用栈内恢复它（FIFO，避免饥饿）。
+ * 跨 Loop 传递数据使用 Channel.hpp 中的 MpscChannel。
+ */
+
+namespace detail
+{
+// 侵入式 FIFO 等待队列，节点需提供 next_ 成员
+template <typename Node>
+class AwaiterQueue
+{
+  public:
+    bool empty() const noexcept
+    {
+        return head_ == nullptr;
+    }
+
+    void push(Node *node) noexcept
+    {
+        node->next_ = nullptr;
+        if (tail_)
+        {
+            tail_->next_ = node;
+        }
+        else
+        {
+            head_ = node;
+        }
+        tail_ = node;
+    }
+
+    Node *pop() noexcept
+    {
+        Node *node = head_;
+        if (node)
+        {
+            head_ = node->next_;
+            if (!head_)
+            {
+                tail_ = nullptr;
+            }
+            node->next_ = nullptr;
+        }
+        return node;
+    }
+
+    // 整体取出（用于关闭时唤醒全部等待者，唤醒过程中可能有新的等待者加入）
+    Node *popAll() noexcept
+    {
+        Node *head = head_;
+        head_ = tail_ = nullptr;
+        return head;
+    }
+
+  private:
+    Node *head_ = nullptr;
+    Node *tail_ = nullptr;
+};
+} // namespace detail
+
+class AsyncMutex;
+
+// AsyncMutex 的 RAII 持有者：析构时解锁，只移动
+class AsyncLockGuard
+{
+  public:
+    explicit AsyncLockGuard(AsyncMutex &mutex) noexcept : mutex_(&mutex) {}
+    AsyncLockGuard(AsyncLockGuard &&other) noexcept : mutex_(std::exchange(other.mutex_, nullptr)) {}
+    AsyncLockGuard(const AsyncLockGuard &) = delete;
+    AsyncLockGuard &operator=(const AsyncLockGuard &) = delete;
+    AsyncLockGuard &operator=(AsyncLockGuard &&) = delete;
+    ~AsyncLockGuard();
+
+  private:
+    AsyncMutex *mutex_;
+};
+
+/**
+ * 协程互斥锁（非递归）
+ *   co_await mutex.lock();  ... mutex.unlock();
+ *   auto guard = co_await mutex.scopedLock();  // 离开作用域自动解锁
+ * 用于串行化同一连接/同一上游上的多步操作（如复用上游连接时的请求-响应配对）
+ */
+class AsyncMutex
+{
+  public:
+    class LockAwaiter
+    {
+      public:
+        explicit LockAwaiter(AsyncMutex &mutex) noexcept : mutex_(mutex) {}
+        bool await_ready() noexcept
+        {
+            return mutex_.tryLock();
+        }
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            handle_ = handle;
+            mutex_.waiters_.push(this);
+        }
+        void await_resume() const noexcept {}
+
+      protected:
+        friend class AsyncMutex;
+        friend class detail::AwaiterQueue<LockAwaiter>;
+
+        AsyncMutex &mutex_;
+        std::coroutine_handle<> handle_;
+        LockAwaiter *next_ = nullptr;
+    };
+
+    class ScopedLockAwaiter : public LockAwaiter
+    {
+      public:
+        using LockAwaiter::LockAwaiter;
+        AsyncLockGuard await_resume() const noexcept
+        {
+            return AsyncLockGuard(mutex_);
+        }
+    };
+
+    AsyncMutex() = default;
+    // 禁用拷贝和赋值（等待者持有本对象的引用）
+    AsyncMutex(const AsyncMutex &) = delete;
+    AsyncMutex &operator=(const AsyncMutex &) = delete;
+
+    // 加锁：未被持有时不挂起
+    LockAwaiter lock() noexcept
+    {
+        return LockAwaiter(*this);
+    }
+    // 加锁并返回 AsyncLockGuard
+    ScopedLockAwaiter scopedLock() noexcept
+    {
+        return ScopedLockAwaiter(*this);
+    }
+    bool tryLock() noexcept
+    {
+        if (locked_)
+        {
+            return false;
+        }
+        locked_ = true;
+        return true;
+    }
+    // 解锁：有等待者时锁直接移交给最早的等待者并恢复它
+    void unlock();
+
+    bool isLocked() const noexcept
+    {
+        return locked_;
+    }
+
+  private:
+    bool locked_ = false;
+    detail::AwaiterQueue<LockAwaiter> waiters_;
+};
+
+inline AsyncLockGuard::~AsyncLockGuard()
+{
+    if (mutex_)
+    {
+        mutex_->unlock();
+    }
+}
+
+/**
+ * 协程计数信号量
+ * 用于并发准入控制，如限制同时进行的排序模型调用数、上游连接池中同时借出的连接数：
+ *   co_await sem.acquire();  ... sem.release();
+ */
+class AsyncSemaphore
+{
+  public:
+    class AcquireAwaiter
+    {
+      public:
+        explicit AcquireAwaiter(AsyncSemaphore &sem) noexcept : sem_(sem) {}
+        bool await_ready() noexcept
+        {
+            return sem_.tryAcquire();
+        }
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            handle_ = handle;
+            sem_.waiters_.push(this);
+        }
+        void await_resume() const noexcept {}
+
+      private:
+        friend class AsyncSemaphore;
+        friend class detail::AwaiterQueue<AcquireAwaiter>;
+
+        AsyncSemaphore &sem_;
+        std::coroutine_handle<> handle_;
+        AcquireAwaiter *next_ = nullptr;
+    };
+
+    explicit AsyncSemaphore(size_t permits) : permits_(permits) {}
+    // 禁用拷贝和赋值（等待者持有本对象的引用）
+    AsyncSemaphore(const AsyncSemaphore &) = delete;
+    AsyncSemaphore &operator=(const AsyncSemaphore &) = delete;
+
+    // 获取一个许可：有剩余许可时不挂起
+    AcquireAwaiter acquire() noexcept
+    {
+        return AcquireAwaiter(*this);
+    }
+    bool tryAcquire() noexcept
+    {
+        // 有等待者时即使有许可也不插队（release 会直接把许可交给等待者，这里只是防御）
+        if (permits_ == 0 || !waiters_.empty())
+        {
+            return false;
+        }
+        --permits_;
+        return true;
+    }
+    // 归还 n 个许可：优先移交给等待者并恢复，剩余的计入可用许可
+    void release(size_t n = 1);
+
+    size_t available() const noexcept
+    {
+        return permits_;
+    }
+    bool hasWaiters() const noexcept
+    {
+        return !waiters_.empty();
+    }
+
+  private:
+    size_t permits_;
+    detail::AwaiterQueue<AcquireAwaiter> waiters_;
+};
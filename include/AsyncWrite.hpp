@@ -2,6 +2,7 @@
 #include <coroutine>
 #include <cstddef>
 
+#include "Deadline.hpp"
 #include "MemoryPool.hpp"
 
 class TcpConnection;
@@ -12,7 +13,7 @@ class AsyncWriteAwaitable
     // 禁用拷贝和赋值
     AsyncWriteAwaitable(const AsyncWriteAwaitable &) = delete;
     AsyncWriteAwaitable &operator=(const AsyncWriteAwaitable &) = delete;
-    // 普通写操作，从 outputBuffer_ 发送数据
+    // 普通写操作：等待 outputBuffer_ 中当前积压的数据全部写完
     AsyncWriteAwaitable(TcpConnection *conn)
         : conn_(conn), regBuf_(nullptr), regBufLen_(0), regBufIdx_(-1), inFd_(-1), offset_(0), count_(0), isZc_(false)
     {
@@ -39,12 +40,18 @@ class AsyncWriteAwaitable
         : conn_(conn), regBuf_(regBuf), regBufLen_(len), regBufIdx_(idx), inFd_(-1), offset_(0), count_(0), isZc_(isZc)
     {
     }
-
-    bool await_ready() const noexcept
+    // asyncSend：数据已追加到 outputBuffer_，进入连接的有序写队列
+    // corked=true 时由 EventLoop 在批处理结束时合并提交，协程默认不挂起
+    // deadline 到期仍未写完时返回 kDeadlineExceeded
+    AsyncWriteAwaitable(TcpConnection *conn, size_t sendBytes, bool corked, Deadline deadline = kNoDeadline)
+        : conn_(conn), regBuf_(nullptr), regBufLen_(0), regBufIdx_(-1), inFd_(-1), offset_(0), count_(0), isZc_(false),
+          isSend_(true), corked_(corked), sendBytes_(sendBytes), deadline_(deadline)
     {
-        return false;
     }
-    void await_suspend(std::coroutine_handle<> handle) noexcept;
+
+    bool await_ready() const noexcept;
+    // 返回 false 表示无需挂起（如写请求无法提交），协程立即继续执行
+    bool await_suspend(std::coroutine_handle<> handle) noexcept;
     int await_resume() const noexcept;
     ~AsyncWriteAwaitable() = default;
 
@@ -68,10 +75,22 @@ class AsyncWriteAwaitable
     off_t offset_; // 文件偏移量（sendfile模式）
     size_t count_; // 发送字节数（sendfile模式）
 
-    // 背压机制相关状态（仅在 kBlock 策略下生效）
-    int totalWritten_ = 0;   // 记录在阻塞期间，底层 io_uring 累计成功写入的字节数
-    bool isBlocked_ = false; // 标记当前协程是否因为触发高水位而进入了阻塞挂起模式
-
     // 零拷贝相关状态
     bool isZc_ = false; // 标记是否是零拷贝发送（用户缓冲区或 sendfile）
+
+    // 有序写队列相关状态（outputBuffer_ 路径）
+    bool isSend_ = false;             // 标记是否是 asyncSend（否则为等待积压数据写完的 asyncWrite）
+    bool corked_ = false;             // 标记是否是 Cork 模式下的 asyncSend
+    size_t sendBytes_ = 0;            // 本次 asyncSend 追加到 outputBuffer_ 的字节数
+    Deadline deadline_ = kNoDeadline; // 本次发送的截止时间
+    size_t waitBytes_ = 0;            // 挂起时需要等待写完的字节数
+    bool suspended_ = false;          // 是否已在写队列中挂起等待
+    bool submitFailed_ = false;       // 写请求无法提交，未挂起
+    int result_ = 0;                  // 写队列回填的写结果（>0 成功，否则为错误码）
+
+    // 是否走 outputBuffer_ 有序写队列（非固定缓冲区/Sendfile/零拷贝）
+    bool isOutputWrite() const noexcept
+    {
+        return regBuf_ == nullptr && inFd_ < 0;
+    }
 };
\ No newline at end of file
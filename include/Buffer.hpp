@@ -48,6 +48,9 @@ public:
     void append(const char *data, size_t len);
     void append(const std::string &str);
 
+    // 交换两个缓冲区的内容（O(1)，仅交换底层 vector 与读写指针，保留各自容量）
+    void swap(Buffer &rhs);
+
     ~Buffer() = default;
 
 private:
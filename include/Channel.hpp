@@ -0,0 +1,359 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "AsyncSync.hpp"
+#include "EventLoop.hpp"
+#include "LockFreeQueue.hpp"
+
+/**
+ * @file Channel.hpp
+ * 协程间传递数据的通道
+ *
+ * - Channel<T>：同一个 EventLoop 线程内的有界多生产者多消费者通道，无原子操作；
+ *   缓冲区满时发送方挂起，空时接收方挂起，capacity 为 0 时退化为同步交接（发送方等到接收方取走才继续）；
+ * - MpscChannel<T>：跨 Loop 的多生产者单消费者通道，任意线程非阻塞发送，
+ *   接收协程始终在自己的 Loop 上通过 queueInLoop 恢复。
+ */
+
+template <typename T>
+class Channel
+{
+  public:
+    class SendAwaiter
+    {
+      public:
+        SendAwaiter(Channel &channel, T value) : channel_(channel), value_(std::move(value)) {}
+        bool await_ready()
+        {
+            return channel_.trySendFrom(*this);
+        }
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            handle_ = handle;
+            channel_.sendWaiters_.push(this);
+        }
+        // 成功送出返回 true，通道已关闭返回 false（数据被丢弃）
+        bool await_resume() const noexcept
+        {
+            return ok_;
+        }
+
+      private:
+        friend class Channel;
+        friend class detail::AwaiterQueue<SendAwaiter>;
+
+        Channel &channel_;
+        T value_;
+        bool ok_ = false;
+        std::coroutine_handle<> handle_;
+        SendAwaiter *next_ = nullptr;
+    };
+
+    class RecvAwaiter
+    {
+      public:
+        explicit RecvAwaiter(Channel &channel) : channel_(channel) {}
+        bool await_ready()
+        {
+            return channel_.tryRecvInto(*this);
+        }
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            handle_ = handle;
+            channel_.recvWaiters_.push(this);
+        }
+        // 通道关闭且数据已取完时返回 std::nullopt
+        std::optional<T> await_resume()
+        {
+            return std::move(value_);
+        }
+
+      private:
+        friend class Channel;
+        friend class detail::AwaiterQueue<RecvAwaiter>;
+
+        Channel &channel_;
+        std::optional<T> value_;
+        std::coroutine_handle<> handle_;
+        RecvAwaiter *next_ = nullptr;
+    };
+
+    explicit Channel(size_t capacity) : capacity_(capacity) {}
+    // 禁用拷贝和赋值（等待者持有本对象的引用）
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    // co_await channel.send(v)：缓冲区满时挂起，返回是否送出
+    SendAwaiter send(T value)
+    {
+        return SendAwaiter(*this, std::move(value));
+    }
+    // co_await channel.recv()：没有数据时挂起
+    RecvAwaiter recv()
+    {
+        return RecvAwaiter(*this);
+    }
+
+    // 关闭通道：挂起的发送方以 false 恢复，挂起的接收方以 std::nullopt 恢复；缓冲区中已有的数据仍可取出
+    void close()
+    {
+        if (closed_)
+        {
+            return;
+        }
+        closed_ = true;
+        // 先整体摘下再恢复：被恢复的协程可能立即再次操作本通道
+        SendAwaiter *sender = sendWaiters_.popAll();
+        RecvAwaiter *receiver = recvWaiters_.popAll();
+        while (sender)
+        {
+            SendAwaiter *next = sender->next_;
+            sender->ok_ = false;
+            sender->handle_.resume();
+            sender = next;
+        }
+        while (receiver)
+        {
+            RecvAwaiter *next = receiver->next_;
+            receiver->handle_.resume();
+            receiver = next;
+        }
+    }
+
+    bool isClosed() const noexcept
+    {
+        return closed_;
+    }
+    size_t size() const noexcept
+    {
+        return buffer_.size();
+    }
+    size_t capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+  private:
+    bool trySendFrom(SendAwaiter &sender)
+    {
+        if (closed_)
+        {
+            sender.ok_ = false;
+            return true;
+        }
+        sender.ok_ = true;
+        // 有接收方在等（此时缓冲区必为空）：直接交给最早的接收方，不经过缓冲区
+        if (RecvAwaiter *receiver = recvWaiters_.pop())
+        {
+            receiver->value_.emplace(std::move(sender.value_));
+            receiver->handle_.resume();
+            return true;
+        }
+        if (buffer_.size() < capacity_)
+        {
+            buffer_.push_back(std::move(sender.value_));
+            return true;
+        }
+        sender.ok_ = false;
+        return false;
+    }
+
+    bool tryRecvInto(RecvAwaiter &receiver)
+    {
+        if (!buffer_.empty())
+        {
+            receiver.value_.emplace(std::move(buffer_.front()));
+            buffer_.pop_front();
+            // 腾出一个位置：把最早挂起的发送方的数据补进缓冲区并恢复它
+            if (SendAwaiter *sender = sendWaiters_.pop())
+            {
+                buffer_.push_back(std::move(sender->value_));
+                sender->ok_ = true;
+                sender->handle_.resume();
+            }
+            return true;
+        }
+        // 同步交接（capacity 为 0）：直接从挂起的发送方取
+        if (SendAwaiter *sender = sendWaiters_.pop())
+        {
+            receiver.value_.emplace(std::move(sender->value_));
+            sender->ok_ = true;
+            sender->handle_.resume();
+            return true;
+        }
+        return closed_;
+    }
+
+    size_t capacity_;
+    bool closed_ = false;
+    std::deque<T> buffer_;
+    detail::AwaiterQueue<SendAwaiter> sendWaiters_;
+    detail::AwaiterQueue<RecvAwaiter> recvWaiters_;
+};
+
+/**
+ * 跨 Loop 的多生产者单消费者通道
+ * - send/close 可在任意线程调用，不挂起：队列满（容量向上取整为 2 的幂）或已关闭时 send 返回 false，由调用方决定丢弃或重试；
+ * - recv 只能在接收方 Loop 线程中 co_await，同一时刻最多一个接收协程；
+ * - 只在接收协程确实挂起时才投递一次 queueInLoop 唤醒，接收方忙时发送只有一次入队操作。
+ * 底层为 LockFreeQueue，T 需要可默认构造、可移动赋值。
+ */
+template <typename T>
+class MpscChannel
+{
+  public:
+    class RecvAwaiter;
+
+  private:
+    // 唤醒任务可能晚于通道析构执行，共享状态由唤醒任务一同持有
+    struct State
+    {
+        State(EventLoop *l, size_t capacity) : loop(l), queue(capacity) {}
+
+        EventLoop *loop;                         // 接收方所在的 Loop
+        LockFreeQueue<T> queue;                  // 待接收的数据
+        std::atomic_bool closed{false};          // 是否已关闭
+        std::atomic<size_t> sending{0};          // 已通过 closed 检查、尚未完成入队的 send 数
+        std::atomic_bool receiverWaiting{false}; // 接收协程是否已挂起且尚未被投递唤醒
+        RecvAwaiter *receiver = nullptr;         // 挂起的接收方，只在接收方 Loop 线程读写
+    };
+
+  public:
+    class RecvAwaiter
+    {
+      public:
+        explicit RecvAwaiter(State &state) : state_(state) {}
+        bool await_ready()
+        {
+            return tryReceive();
+        }
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            handle_ = handle;
+            return !park();
+        }
+        // 通道关闭且数据已取完时返回 std::nullopt
+        std::optional<T> await_resume()
+        {
+            return std::move(value_);
+        }
+
+      private:
+        friend class MpscChannel;
+
+        // 真正出队一次来判断是否就绪：取到数据，或确认通道已关闭且取空时返回 true，结果保存在 value_ 中。
+        // 只看 empty() 不可靠：发送方占了槽位但尚未写完时 empty() 为 false，dequeue 却会失败
+        bool tryReceive()
+        {
+            // 先读 closed 再读 sending（均为 seq_cst），与 send 中"先登记 sending、再检查 closed"配对：
+            // 看到已关闭且 sending 为 0 时，关闭前通过检查的发送都已入队完成，之后的出队一定能看到
+            bool closed = state_.closed.load();
+            bool drained = closed && state_.sending.load() == 0;
+            T value;
+            if (state_.queue.dequeue(value))
+            {
+                value_.emplace(std::move(value));
+                ready_ = true;
+                return true;
+            }
+            if (!drained)
+            {
+                // 未关闭，或关闭前通过检查的发送尚未入队完成：挂起等待，发送完成后会唤醒
+                return false;
+            }
+            ready_ = true;
+            return true;
+        }
+
+        // 登记为挂起的接收方：登记后立即就绪且抢回了唤醒权时返回 true（不挂起/直接恢复）
+        bool park()
+        {
+            state_.receiver = this;
+            state_.receiverWaiting.store(true);
+            // 登记之后再取一次：与发送方"先入队、再检查 receiverWaiting"配对，保证不丢唤醒
+            if (tryReceive() && state_.receiverWaiting.exchange(false))
+            {
+                state_.receiver = nullptr;
+                return true;
+            }
+            // 仍未就绪，或发送方已抢先投递唤醒（结果已保存在 value_，等唤醒任务恢复）
+            return false;
+        }
+
+        State &state_;
+        std::coroutine_handle<> handle_;
+        std::optional<T> value_; // 已取到的数据
+        bool ready_ = false;     // 已取到数据或确认通道关闭且取空
+    };
+
+    // loop 为接收方所在的 Loop
+    MpscChannel(EventLoop *loop, size_t capacity) : state_(std::make_shared<State>(loop, capacity)) {}
+    // 禁用拷贝和赋值
+    MpscChannel(const MpscChannel &) = delete;
+    MpscChannel &operator=(const MpscChannel &) = delete;
+
+    // 任意线程调用：非阻塞发送，队列满或通道已关闭时返回 false
+    // 返回 true 的数据一定会被接收方取到：与 close 并发时，接收方等在途的 send 完成入队后才判定"已关闭且取空"
+    bool send(T value)
+    {
+        state_->sending.fetch_add(1);
+        bool ok = !state_->closed.load() && state_->queue.enqueue(std::move(value));
+        state_->sending.fetch_sub(1);
+        // 入队成功需要唤醒；已关闭时接收方可能正等着在途的发送完成，同样需要唤醒
+        if (ok || state_->closed.load(std::memory_order_acquire))
+        {
+            wakeReceiver();
+        }
+        return ok;
+    }
+
+    // 接收方 Loop 线程中 co_await
+    RecvAwaiter recv()
+    {
+        return RecvAwaiter(*state_);
+    }
+
+    // 任意线程调用：关闭后 send 失败，接收方取完已入队的数据后得到 std::nullopt
+    void close()
+    {
+        state_->closed.store(true);
+        wakeReceiver();
+    }
+
+    bool isClosed() const noexcept
+    {
+        return state_->closed.load(std::memory_order_acquire);
+    }
+
+  private:
+    void wakeReceiver()
+    {
+        // 只有一个发送方能把 receiverWaiting 从 true 交换为 false，每次挂起只投递一次唤醒
+        if (state_->receiverWaiting.exchange(false))
+        {
+            // 唤醒不可丢弃：接收方 Loop 的任务队列满时转入溢出链表
+            state_->loop->queueInLoopOrOverflow([state = state_]() {
+                RecvAwaiter *receiver = std::exchange(state->receiver, nullptr);
+                if (!receiver)
+                {
+                    return;
+                }
+                // 唤醒时队首的数据可能还没发布（更早占位的发送方尚未写完），或关闭时仍有在途的发送：
+                // 此时重新登记等待，而不是带着空结果恢复
+                if (receiver->ready_ || receiver->tryReceive() || receiver->park())
+                {
+                    receiver->handle_.resume();
+                }
+            });
+        }
+    }
+
+    std::shared_ptr<State> state_;
+};
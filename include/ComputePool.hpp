@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "LockFreeQueue.hpp"
+
+/**
+ * 计算线程池：运行从 IO Loop 迁移过来的 CPU 密集型协程片段（如排序模型打分）
+ *
+ *   EventLoop *ioLoop = conn->getLoop();
+ *   co_await computePool.schedule(); // 之后的代码在计算线程上执行，不再阻塞 IO Loop 上的其他连接
+ *   auto response = handler->handleRecommendation(request);
+ *   co_await ioLoop->schedule();     // 回到连接所属的 IO Loop 发送响应
+ *
+ * 任务队列为协程句柄的无锁队列，只在有空闲线程睡眠时才加锁唤醒，繁忙时投递只有一次入队操作。
+ * 计算线程没有 EventLoop，不能在其上提交 io_uring 请求；协程帧的释放会退回 malloc/free。
+ */
+class ComputePool
+{
+  public:
+    class ScheduleAwaitable
+    {
+      public:
+        explicit ScheduleAwaitable(ComputePool *pool) : pool_(pool) {}
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        // 队列已满或线程池未运行时不挂起，协程在当前线程继续执行（退化为同步计算）
+        bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            return pool_->post(handle);
+        }
+        void await_resume() const noexcept {}
+
+      private:
+        ComputePool *pool_;
+    };
+
+    struct Stats
+    {
+        uint64_t executed = 0; // 已执行的协程片段数
+        uint64_t rejected = 0; // 因队列满/未运行而在调用线程执行的次数
+    };
+
+    explicit ComputePool(size_t numThreads, size_t queueCapacity = 65536);
+    ~ComputePool();
+
+    // 禁止拷贝和赋值
+    ComputePool(const ComputePool &) = delete;
+    ComputePool &operator=(const ComputePool &) = delete;
+
+    void start();
+    // 停止接收新任务，等待队列中已有的协程片段执行完毕后回收线程
+    void stop();
+
+    ScheduleAwaitable schedule()
+    {
+        return ScheduleAwaitable(this);
+    }
+
+    // 投递协程句柄，由任一计算线程恢复；失败返回 false
+    bool post(std::coroutine_handle<> handle);
+
+    size_t threadNum() const
+    {
+        return numThreads_;
+    }
+    Stats getStats() const;
+
+  private:
+    void workerLoop();
+
+    size_t numThreads_;
+    LockFreeQueue<std::coroutine_handle<>> queue_;
+    std::vector<std::thread> threads_;
+    std::atomic_bool running_{false};
+    std::atomic<size_t> posting_{0}; // 已通过 running_ 检查、尚未完成投递的 post 数，stop 等它归零后再做最后的清空
+
+    // 空闲线程睡眠/唤醒
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::atomic<size_t> idleWorkers_{0}; // 正在（或即将）睡眠的线程数，投递方据此决定是否需要加锁通知
+
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> rejected_{0};
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <coroutine>
+#include <liburing.h>
+#include <memory>
+
+#include "Deadline.hpp"
+#include "InetAddress.hpp"
+#include "IoContext.hpp"
+
+class EventLoop;
+class TcpConnection;
+
+/**
+ * @file Connector.hpp
+ * 客户端异步连接：基于 IORING_OP_CONNECT，建立成功后的连接与服务端 accept 的连接一样是 TcpConnection，
+ * 收发使用同一套 asyncRead/asyncSend 协程接口
+ *
+ *   ConnectResult r = co_await asyncConnect(loop, InetAddress(9000, "10.0.0.2"), deadlineAfter(50ms));
+ *   if (!r)
+ *   {
+ *       LOG_WARN("connect failed: {}", r.error); // 截止时间到期为 kDeadlineExceeded
+ *   }
+ */
+
+struct ConnectResult
+{
+    std::shared_ptr<TcpConnection> conn; // 连接成功时为已建立的连接
+    int error = 0;                       // 失败时为负的错误码
+
+    explicit operator bool() const noexcept
+    {
+        return conn != nullptr;
+    }
+};
+
+class ConnectAwaitable
+{
+  public:
+    // loop 为连接所属的 Loop，必须在该 Loop 线程中 co_await
+    // deadline 不为 kNoDeadline 时 connect 请求链接一个绝对时间的 LINK_TIMEOUT，到期未连上返回 kDeadlineExceeded
+    ConnectAwaitable(EventLoop *loop, const InetAddress &addr, Deadline deadline = kNoDeadline)
+        : loop_(loop), addr_(addr), deadline_(deadline), connectContext_(IoType::Connect, -1)
+    {
+    }
+    // 禁用拷贝和赋值
+    ConnectAwaitable(const ConnectAwaitable &) = delete;
+    ConnectAwaitable &operator=(const ConnectAwaitable &) = delete;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+    // 创建 socket 或获取 SQE 失败时不挂起，直接以错误结果继续
+    bool await_suspend(std::coroutine_handle<> handle) noexcept;
+    ConnectResult await_resume();
+    // 取消在途的 connect（when_any 取消落败者时调用），协程随后以 -ECANCELED 恢复
+    void cancel() noexcept;
+
+  private:
+    EventLoop *loop_;                  // 连接所属的 Loop
+    InetAddress addr_;                 // 对端地址
+    Deadline deadline_;                // 连接截止时间
+    int fd_ = -1;                      // 正在连接的 socket
+    IoContext connectContext_;         // connect 请求的上下文（协程模式）
+    __kernel_timespec deadlineSpec_{}; // 截止时间的绝对时间结构体
+};
+
+// co_await asyncConnect(loop, addr, deadline)：在 loop 上异步建立到 addr 的 TCP 连接
+inline ConnectAwaitable asyncConnect(EventLoop *loop, const InetAddress &addr, Deadline deadline = kNoDeadline)
+{
+    return ConnectAwaitable(loop, addr, deadline);
+}
@@ -2,31 +2,194 @@
 
 #include <coroutine>
 #include <exception>
+#include <optional>
+#include <type_traits>
 #include <utility>
+#include "FramePool.hpp"
 #include "MemoryPool.hpp"
 
 /**
- * @brief 简单的协程任务类 (Coroutine Return Object)
- * 用于封装协程的状态和生命周期
+ * @brief 即发即弃的协程任务 (Coroutine Return Object)
+ * 创建后立即执行，结束后自动销毁自身，调用者无法等待其结果。
+ * 适合作为连接处理协程等"根协程"，内部再通过 co_await Task<T> 组合子协程。
  */
-struct Task
+struct DetachedTask
 {
     struct promise_type
     {
-        Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        DetachedTask get_return_object() { return DetachedTask{std::coroutine_handle<promise_type>::from_promise(*this)}; }
         std::suspend_never initial_suspend() { return {}; }        // 协程创建后立即执行
         std::suspend_never final_suspend() noexcept { return {}; } // 协程结束后不挂起，立即销毁自身
         void return_void() {}                                      // 表示协程无返回值
         void unhandled_exception() { std::terminate(); }           // 协程出错时终止程序
 
+        // 协程帧从当前线程（EventLoop）的帧池分配
+        static void *operator new(size_t size) { return FramePool::allocate(size); }
+        static void operator delete(void *p, size_t size) { FramePool::deallocate(p, size); }
     };
 
     std::coroutine_handle<promise_type> handle_;
 
-    Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
-    ~Task()
+    DetachedTask(std::coroutine_handle<promise_type> h) : handle_(h) {}
+    ~DetachedTask()
     {
         // 由于 final_suspend 返回 suspend_never，协程会自动销毁，
         // 这里不需要手动 destroy，除非我们改变了 final_suspend 的行为。
     }
 };
+
+template <typename T = void>
+class Task;
+
+namespace detail
+{
+// Task 结束时的挂起点：对称转移到等待它的父协程，父协程不存在时转移到 noop
+// 通过返回协程句柄而不是在 await_suspend 内调用 resume()，深层调用链结束时不会逐层压栈
+struct TaskFinalAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+        std::coroutine_handle<> continuation = handle.promise().continuation_;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+};
+
+struct TaskPromiseBase
+{
+    std::suspend_always initial_suspend() noexcept { return {}; } // 惰性启动：被 co_await 时才开始执行
+    TaskFinalAwaiter final_suspend() noexcept { return {}; }      // 结束后挂起，由 Task 析构时销毁协程帧
+    void unhandled_exception() { exception_ = std::current_exception(); } // 异常保存下来，在父协程中重新抛出
+
+    // 协程帧从当前线程（EventLoop）的帧池分配
+    static void *operator new(size_t size) { return FramePool::allocate(size); }
+    static void operator delete(void *p, size_t size) { FramePool::deallocate(p, size); }
+
+    std::coroutine_handle<> continuation_; // 等待本协程的父协程
+    std::exception_ptr exception_;         // 协程体抛出的异常
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase
+{
+    Task<T> get_return_object();
+
+    template <typename U>
+    void return_value(U &&value)
+    {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T result()
+    {
+        if (exception_)
+        {
+            std::rethrow_exception(exception_);
+        }
+        return std::move(*value_);
+    }
+
+    std::optional<T> value_; // 协程返回值
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase
+{
+    Task<void> get_return_object();
+
+    void return_void() {}
+
+    void result()
+    {
+        if (exception_)
+        {
+            std::rethrow_exception(exception_);
+        }
+    }
+};
+} // namespace detail
+
+/**
+ * @brief 可等待、带返回值的惰性协程任务
+ * - 创建时不执行，被父协程 co_await 时才开始运行，运行结束后父协程以对称转移的方式恢复；
+ * - co_await 的结果为协程 co_return 的值，协程体内的异常在父协程的 co_await 处重新抛出；
+ * - Task 对象独占协程帧，析构时销毁（只移动，不可拷贝）。
+ * 根协程不能被 co_await，使用 spawn() 启动。
+ */
+template <typename T>
+class Task
+{
+  public:
+    using promise_type = detail::TaskPromise<T>;
+    using value_type = T;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    // 禁用拷贝和赋值
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    bool done() const noexcept { return !handle_ || handle_.done(); }
+
+    struct Awaiter
+    {
+        std::coroutine_handle<promise_type> handle_;
+
+        bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+        // 记录父协程后直接转移到子协程执行（对称转移，不经过 resume 压栈）
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+        {
+            handle_.promise().continuation_ = continuation;
+            return handle_;
+        }
+        T await_resume() { return handle_.promise().result(); }
+    };
+
+    // 只允许对右值 co_await（co_await task() 或 co_await std::move(task)），避免同一个 Task 被等待两次
+    Awaiter operator co_await() && noexcept { return Awaiter{handle_}; }
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail
+{
+template <typename T>
+inline Task<T> TaskPromise<T>::get_return_object()
+{
+    return Task<T>{std::coroutine_handle<TaskPromise<T>>::from_promise(*this)};
+}
+
+inline Task<void> TaskPromise<void>::get_return_object()
+{
+    return Task<void>{std::coroutine_handle<TaskPromise<void>>::from_promise(*this)};
+}
+} // namespace detail
+
+// 在当前线程启动一个根 Task：立即运行到第一个挂起点，结束后自动回收；未捕获的异常会终止程序
+inline DetachedTask spawn(Task<void> task)
+{
+    co_await std::move(task);
+}
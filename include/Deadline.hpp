@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+
+/**
+ * 单次 IO 操作的截止时间
+ * 使用 steady_clock（Linux 上即 CLOCK_MONOTONIC），与 io_uring 绝对时间超时（IORING_TIMEOUT_ABS）的默认时钟一致，
+ * 可以直接换算为 LINK_TIMEOUT 的 timespec，不需要在提交时再读一次时钟换算相对时间
+ */
+using Deadline = std::chrono::steady_clock::time_point;
+
+// 不设截止时间
+inline constexpr Deadline kNoDeadline = Deadline::max();
+
+// 截止时间到达时带截止时间的 Awaitable 返回的结果，与对端关闭（0）、被取消（-ECANCELED）等结果区分
+inline constexpr int kDeadlineExceeded = -ETIMEDOUT;
+
+// 从现在起 timeout 之后的截止时间，如 deadlineAfter(std::chrono::milliseconds(30))
+inline Deadline deadlineAfter(std::chrono::steady_clock::duration timeout)
+{
+    return std::chrono::steady_clock::now() + timeout;
+}
+
+inline bool deadlineExpired(Deadline deadline)
+{
+    return deadline != kNoDeadline && std::chrono::steady_clock::now() >= deadline;
+}
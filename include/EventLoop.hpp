@@ -1,17 +1,29 @@
 #pragma once
 
 #include <liburing.h>
+#include <unistd.h>
 
 #include <atomic>
 #include <cstdint>
+#include <chrono>
+#include <coroutine>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <vector>
 
 #include "Buffer.hpp"
+#include "Deadline.hpp"
+#include "FramePool.hpp"
 #include "IoContext.hpp"
 #include "LockFreeQueue.hpp"
+#include "LoopClock.hpp"
+#include "RequestArena.hpp"
+
+class IdleTimingWheel;
+class TcpConnectionPool;
+class TimerQueue;
 
 /**
  * 事件循环类，负责管理和分发事件。
@@ -35,6 +47,18 @@ class EventLoop
         // 当队列长度回落到低水位时，触发恢复回调，表示系统已消化积压任务
         size_t pendingQueueLowWaterMark = 26214; // 默认低水位：容量的 40%
         bool enableQueueFullStats = true;        // 是否开启队列满的统计告警
+        // 空闲连接时间轮配置：tick 间隔即空闲超时的精度，槽位数决定一圈覆盖的时长
+        std::chrono::milliseconds idleWheelTick{1000};
+        size_t idleWheelSlots = 64;
+        // TcpConnection 对象池中最多缓存的空闲对象数，0 表示不缓存
+        size_t connectionPoolCapacity = 4096;
+        // 定时器时间轮的 tick 间隔，即 runAfter/runEvery/sleepFor 的精度
+        std::chrono::milliseconds timerTick{1};
+        // AsyncSleep 的最大定时器松弛：到期时间向上取整到该粒度，相近的睡眠在同一时刻到期、合并为一批 CQE
+        // 0 表示不取整
+        std::chrono::milliseconds timerSlack{0};
+        // 每轮循环的时钟快照使用 CLOCK_MONOTONIC_COARSE/CLOCK_REALTIME_COARSE：开销更小，精度为一个调度 tick
+        bool coarseClock = false;
     };
 
     using Functor = std::function<void()>;
@@ -55,10 +79,74 @@ class EventLoop
     // 让 EventLoop 停止运行
     void quit();
 
+    // 当前线程所属的 EventLoop（EventLoop 在其线程中构造时登记），非 Loop 线程返回 nullptr
+    static EventLoop *current();
+
+    // 提交 IORING_OP_ASYNC_CANCEL，取消以 ctx 为 user_data 的所有在途请求（被取消的请求以 -ECANCELED 完成）
+    // 取消请求本身的 CQE 不做处理；仅允许在 Loop 线程内调用
+    void cancelIo(IoContext *ctx);
+
+    // 给 sqe 链接一个绝对时间的 LINK_TIMEOUT（IOSQE_IO_LINK + IORING_TIMEOUT_ABS），截止时间到达时 sqe 以 -ECANCELED 完成
+    // spec 由调用者持有，至少保留到本轮提交；返回超时 SQE 由调用者绑定 user_data，SQ 满时返回 nullptr 且不设置链接
+    struct io_uring_sqe *linkDeadline(struct io_uring_sqe *sqe, Deadline deadline, __kernel_timespec *spec);
+
+    // 暂存一个绝对时间的定时器 timeout（IORING_TIMEOUT_ABS），在本轮批处理结束、提交之前优先写入 SQ
+    // 不单独调用 io_uring_submit，定时器随批量请求一起提交；ctx/spec 由调用者持有到 CQE 返回
+    // 仅允许在 Loop 线程内调用
+    void stageTimeout(IoContext *ctx, __kernel_timespec *spec);
+    // 撤回尚未写入 SQ 的定时器：成功返回 true（不会再有 CQE），已写入 SQ 时返回 false，应改用 cancelIo
+    bool unstageTimeout(IoContext *ctx);
+    // 按 Options::timerSlack 把到期时间向上取整到松弛粒度
+    Deadline applyTimerSlack(Deadline deadline) const;
+
+    // 本轮循环开始时的单调时钟/墙上时钟快照（同一批 CQE 的处理共用一次读数），仅允许在 Loop 线程内调用
+    // 用于统计、空闲淘汰等对误差不敏感的场景；快照落后于本轮已耗费的时间，相对定时的起点应使用 deadlineAfter
+    Deadline now() const noexcept
+    {
+        return clock_.monotonic();
+    }
+    std::chrono::system_clock::time_point wallNow() const noexcept
+    {
+        return clock_.wall();
+    }
+
+    // 当前线程是否为 Loop 所属线程
+    bool isInLoopThread() const
+    {
+        return ::gettid() == threadId_;
+    }
     // 在当前 Loop 线程执行回调
     void runInLoop(Functor cb);
-    // 把回调放入任务队列，并唤醒对应的 enentLoop 线程执行
-    void queueInLoop(Functor cb);
+    // 把回调放入任务队列，并唤醒对应的 enentLoop 线程执行；队列已满时丢弃并返回 false
+    // 唤醒是合并的：Loop 取走任务之前的多次跨线程投递只写一次 eventfd
+    bool queueInLoop(Functor cb);
+    // 不可丢弃的跨线程投递（如迁移协程、回收连接）：队列已满时转入加锁的溢出链表，由本 Loop 在下一轮取出执行。
+    // 调用方不会阻塞等待目标 Loop 腾出队列空间，两个 Loop 互相投递时也不会死锁；Loop 已退出时任务随 Loop 一起丢弃
+    void queueInLoopOrOverflow(Functor cb);
+
+    // co_await loop->schedule()：把当前协程迁移到本 Loop 线程上继续执行（已在本 Loop 线程时不挂起）
+    // 典型用法是在计算线程池完成 CPU 密集计算后回到连接所属的 IO Loop 发送响应
+    class ScheduleAwaitable
+    {
+      public:
+        explicit ScheduleAwaitable(EventLoop *loop) : loop_(loop) {}
+        bool await_ready() const noexcept
+        {
+            return loop_->isInLoopThread();
+        }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+
+      private:
+        EventLoop *loop_;
+    };
+    ScheduleAwaitable schedule()
+    {
+        return ScheduleAwaitable(this);
+    }
+    // 登记一个在本轮 CQE 批处理（含任务队列）结束后执行的回调，仅允许在 Loop 线程内调用
+    // 用于写合并（Cork）等需要"攒一批再统一提交"的场景，回调产生的 SQE 会在下一轮循环开头统一提交
+    void runAfterBatch(Functor cb);
 
     // 协程恢复逻辑，当 io_uring_wait_cqe 返回时调用
     void handleCompletionEvent(struct io_uring_cqe *cqe);
@@ -78,6 +166,33 @@ class EventLoop
     // 根据索引取得缓冲区指针
     void *getRegisteredBuffer(int idx);
 
+    // 单个已注册缓冲区的大小
+    size_t getRegisteredBufferSize() const
+    {
+        return options_.registeredBuffersSize;
+    }
+
+    // 本 Loop 的空闲连接时间轮（首次调用时创建），仅允许在 Loop 线程内调用
+    IdleTimingWheel &getIdleTimingWheel();
+    // 本 Loop 的定时器（首次调用时创建），仅允许在 Loop 线程内调用
+    TimerQueue &getTimerQueue();
+    // 本 Loop 线程的协程帧池（构造时登记为线程的当前帧池），统计信息仅应在 Loop 线程读取
+    const FramePool &getFramePool() const
+    {
+        return framePool_;
+    }
+    // 本 Loop 线程的请求 arena 块池（构造时登记为线程的当前块池），统计信息仅应在 Loop 线程读取
+    const ArenaChunkPool &getArenaChunkPool() const
+    {
+        return arenaChunkPool_;
+    }
+
+    // 本 Loop 的 TcpConnection 对象池，acquire 可在任意线程调用
+    TcpConnectionPool &getConnectionPool()
+    {
+        return *connectionPool_;
+    }
+
     // 设置背压回调（当队列水位变化时触发）
     void setBackpressureCallback(const BackpressureCallback &cb)
     {
@@ -105,6 +220,12 @@ class EventLoop
     void doPendingFunctors();
     // 提交异步读操作以监听 wakeupFd_
     void asyncReadWakeup();
+    // 执行本轮批处理结束回调
+    void doBatchEndFunctors();
+    // 把暂存的定时器 timeout 写入 SQ
+    void flushStagedTimeouts();
+    // queueInLoop 的实现：只在入队成功时移走 cb
+    bool tryQueueInLoop(Functor &cb);
 
     Options options_;
     std::atomic_bool running_; // 事件循环是否在运行
@@ -117,8 +238,24 @@ class EventLoop
 
     //   std::mutex mutex_;
     //   std::vector<Functor> pendingFunctors_;
-    LockFreeQueue<Functor> pendingFunctors_;
+    LockFreeQueue<Functor, QueueMode::MPSC> pendingFunctors_; // 任意线程投递，只有 Loop 线程取出
     bool callingPendingFunctors_; // 是否正在执行任务队列
+    std::atomic_bool wakeupPending_{false}; // 已写 eventfd、Loop 尚未开始取任务，期间的投递不再重复唤醒
+    std::mutex overflowMutex_;               // 保护 overflowFunctors_
+    std::vector<Functor> overflowFunctors_;  // 任务队列满时不可丢弃的投递
+    std::atomic_bool hasOverflow_{false};    // overflowFunctors_ 非空，Loop 据此决定是否加锁取出
+
+    // 批处理结束回调，仅 Loop 线程访问，无需加锁；双 vector 轮换以复用容量
+    std::vector<Functor> batchEndFunctors_;
+    std::vector<Functor> runningBatchEndFunctors_;
+
+    // 暂存的定时器 timeout，仅 Loop 线程访问
+    struct StagedTimeout
+    {
+        IoContext *ctx;
+        __kernel_timespec *spec;
+    };
+    std::vector<StagedTimeout> stagedTimeouts_;
 
     // 背压管理
     BackpressureCallback backpressureCallback_; // 水位变化回调
@@ -130,4 +267,11 @@ class EventLoop
 
     // 极致性能优化：单线程模型下无需锁或原子操作，直接用 vector 当栈
     std::vector<int> freeBufferIndices_; // 可用缓冲区索引栈
+
+    FramePool framePool_;                               // 协程帧池，仅 Loop 线程访问
+    ArenaChunkPool arenaChunkPool_;                     // 请求 arena 的空闲块，仅 Loop 线程访问
+    LoopClock clock_;                                   // 每轮循环的时钟快照，仅 Loop 线程访问
+    std::unique_ptr<IdleTimingWheel> idleTimingWheel_;  // 空闲连接时间轮，按需创建
+    std::unique_ptr<TimerQueue> timerQueue_;            // 分层时间轮定时器，按需创建
+    std::shared_ptr<TcpConnectionPool> connectionPool_; // 连接对象池（删除器持有其 shared_ptr，可能晚于 Loop 析构）
 };
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+constexpr size_t FRAME_SIZE_CLASS_NUM = 64;                                      // 协程帧大小类别数
+constexpr size_t FRAME_SIZE_CLASS_STEP = 64;                                     // 每个类别的跨度（字节）
+constexpr size_t MAX_POOLED_FRAME_SIZE = FRAME_SIZE_CLASS_NUM * FRAME_SIZE_CLASS_STEP; // 超过此大小直接 malloc
+constexpr size_t FRAME_CACHE_LIMIT = 1024;                                       // 每个类别最多缓存的空闲帧数
+
+/**
+ * 协程帧池：每个 EventLoop 持有一个，并在所属线程中登记为 thread_local 的当前帧池
+ *
+ * Task/DetachedTask 的 promise_type 重载了 operator new/delete，协程帧从当前线程的帧池按 64 字节
+ * 大小类别分配，释放时回到释放线程的帧池（帧是独立 malloc 的内存块，跨线程释放只是换一个空闲链表）。
+ * - 帧池只在所属线程访问，不需要加锁；
+ * - 线程没有帧池（如 EventLoop 创建之前的主线程）或帧大于 MAX_POOLED_FRAME_SIZE 时直接使用 malloc/free；
+ * - operator delete 使用带大小的版本，因此帧不需要额外的头部记录大小类别。
+ */
+class FramePool
+{
+public:
+    FramePool() = default;
+    ~FramePool();
+
+    // 禁用拷贝和赋值
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    // 把本帧池登记为当前线程的帧池（EventLoop 构造时调用）
+    void attachToCurrentThread();
+    // 取消登记（EventLoop 析构时调用）
+    void detachFromCurrentThread();
+
+    // 协程帧分配/释放入口，供 promise_type::operator new/delete 使用
+    static void *allocate(size_t size);
+    static void deallocate(void *p, size_t size);
+
+    struct Stats
+    {
+        uint64_t allocations = 0;      // 分配次数
+        uint64_t cacheHits = 0;        // 从空闲链表命中的次数
+        uint64_t largeAllocations = 0; // 超过最大类别、直接 malloc 的次数
+        uint64_t deallocations = 0;    // 释放次数（含其他线程分配、在本线程释放的帧）
+        size_t cachedBytes = 0;        // 空闲链表中缓存的字节数
+        size_t peakLiveBytes = 0;      // 在用帧字节数的峰值（按本线程的分配与释放估算）
+        // 帧大小分布：第 i 项为大小落在 ((i)*64, (i+1)*64] 的分配次数，最后一项为大帧
+        std::array<uint64_t, FRAME_SIZE_CLASS_NUM + 1> sizeHistogram{};
+    };
+    const Stats &getStats() const { return stats_; }
+
+private:
+    struct FreeFrame
+    {
+        FreeFrame *next;
+    };
+
+    static size_t sizeClassOf(size_t size) { return (size + FRAME_SIZE_CLASS_STEP - 1) / FRAME_SIZE_CLASS_STEP - 1; }
+    static size_t classBytes(size_t cls) { return (cls + 1) * FRAME_SIZE_CLASS_STEP; }
+
+    void *allocateFrame(size_t size);
+    void deallocateFrame(void *p, size_t size);
+
+    std::array<FreeFrame *, FRAME_SIZE_CLASS_NUM> freeLists_{}; // 各大小类别的空闲帧链表
+    std::array<size_t, FRAME_SIZE_CLASS_NUM> freeCounts_{};     // 各类别空闲帧数量
+    size_t liveBytes_ = 0;                                      // 当前在用帧字节数（可能因跨线程释放而偏差）
+    Stats stats_;
+
+    static thread_local FramePool *current_; // 当前线程的帧池
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <liburing.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "IoContext.hpp"
+
+class EventLoop;
+class TcpConnection;
+
+/**
+ * 空闲连接超时的哈希时间轮（每个 EventLoop 一个，仅 Loop 线程访问）
+ *
+ * 与"每次读请求链接一个 IORING_OP_LINK_TIMEOUT"相比：
+ * - 读路径上不再额外占用 SQE，也不会为每次读在内核中创建/销毁一个定时器；
+ * - 连接只记录最近一次活跃时的 tick 值（一次整数写入），时间轮由单个周期性 timeout SQE 驱动；
+ * - 每个 tick 只扫描当前槽位：已超时的连接批量关闭，仍活跃的连接按"最近活跃 tick + 超时 tick"惰性挂回对应槽位。
+ * 超时精度为一个 tick，适合秒级的空闲连接清理，不适合精确的单次读超时。
+ */
+class IdleTimingWheel
+{
+  public:
+    IdleTimingWheel(EventLoop *loop, std::chrono::milliseconds tick, size_t slots);
+    ~IdleTimingWheel() = default;
+
+    // 禁用拷贝和赋值
+    IdleTimingWheel(const IdleTimingWheel &) = delete;
+    IdleTimingWheel &operator=(const IdleTimingWheel &) = delete;
+
+    // 开始跟踪连接的空闲时间，timeout 向上取整为 tick 的整数倍；连接关闭后在下一次被扫描时自动移除
+    void add(const std::shared_ptr<TcpConnection> &conn, std::chrono::milliseconds timeout);
+
+    // 当前 tick 计数，连接以此记录最近活跃时间
+    uint64_t currentTick() const
+    {
+        return currentTick_;
+    }
+
+    // 统计信息
+    struct Stats
+    {
+        uint64_t ticks = 0;              // 已处理的 tick 数
+        uint64_t expiredConnections = 0; // 因空闲超时被关闭的连接数
+        uint64_t reinsertions = 0;       // 扫描时仍活跃、被挂回时间轮的次数
+        size_t trackedConnections = 0;   // 当前在轮中的条目数（含尚未清理的已关闭连接）
+    };
+    Stats getStats() const
+    {
+        Stats stats = stats_;
+        stats.trackedConnections = size_;
+        return stats;
+    }
+
+  private:
+    struct Entry
+    {
+        std::weak_ptr<TcpConnection> conn; // 弱引用，时间轮不延长连接的生命周期
+        uint64_t timeoutTicks;             // 空闲超时对应的 tick 数
+    };
+
+    // 把条目挂到 deadline 对应的槽位（超过一圈的条目会提前被扫描到，届时再按剩余时间挂回）
+    void schedule(Entry &&entry, uint64_t deadline);
+    // 提交下一次 tick 的 timeout SQE
+    void armTick();
+    // tick 到期回调：推进时间轮并处理当前槽位
+    void handleTick(int res);
+
+    EventLoop *loop_;
+    std::chrono::milliseconds tick_;        // tick 间隔
+    struct __kernel_timespec tickSpec_;     // tick 间隔的内核时间结构体
+    IoContext tickContext_;                 // tick timeout 的上下文（回调模式）
+    std::vector<std::vector<Entry>> slots_; // 槽位
+    std::vector<Entry> scanning_;           // 正在扫描的槽位，与槽位交换以复用容量
+    uint64_t currentTick_ = 0;              // 当前 tick
+    size_t size_ = 0;                       // 轮中条目总数
+    bool armed_ = false;                    // 是否有 tick 在途；轮为空时停止 tick，避免空闲 Loop 被周期唤醒
+    Stats stats_;
+};
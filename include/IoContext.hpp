@@ -43,7 +43,12 @@ struct IoContext
 
     int result_; // 暂存 IO 操作结果，用作将io_uring读写操作的结果中转到协程
 
-    IoContext(IoType t, int f) : type(t), fd(f), idx(-1), coro_handle(nullptr), result_(0), handler(nullptr)
+    // 以本上下文为 user_data 、尚未收到最终 CQE 的请求数（目前只有 TcpConnection 的上下文计数）
+    // TcpConnection 对象池据此判断对象能否复用：仍有请求在途时复用，迟到的 CQE 会被分发给下一个连接
+    unsigned inflight;
+
+    IoContext(IoType t, int f)
+        : type(t), fd(f), idx(-1), coro_handle(nullptr), result_(0), handler(nullptr), inflight(0)
     {
     }
 
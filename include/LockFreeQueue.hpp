@@ -5,9 +5,25 @@
 #include <utility>
 #include <vector>
 
-// MPMC环形无锁队列（多生产者多消费者）
+// 环形无锁队列的并发模式：按实际的生产者/消费者数量选择，单方一侧不再需要 CAS
+enum class QueueMode
+{
+    MPMC, // 多生产者多消费者（默认）
+    MPSC, // 多生产者单消费者：出队只有一个线程，出队位置用普通的 store 推进
+    SPSC  // 单生产者单消费者：两端都没有 CAS
+};
 
-template <typename T> class LockFreeQueue
+// 环形无锁队列（Vyukov 有界队列，默认多生产者多消费者）
+//
+// 每个槽带一个序列号：序列号 == 位置 表示可写，== 位置 + 1 表示可读。多方一侧用 CAS 抢占位置，
+// 单方一侧（MPSC 的消费者、SPSC 的两端）直接推进位置，每个元素只剩一次对槽序列号的 acquire 读和 release 写。
+//
+// 批量接口先按序列号扫描连续可用的槽，再用一次原子操作预留整段位置：
+//   queue.enqueueBulk(items.begin(), items.size());                 // 全部入队或一个都不入队
+//   size_t n = queue.dequeueBulk(std::back_inserter(out), 4096);     // 最多取 4096 个
+// 传入 std::make_move_iterator 可以把元素移动进队列。
+
+template <typename T, QueueMode Mode = QueueMode::MPMC> class LockFreeQueue
 {
   private:
     struct Slot
@@ -16,6 +32,9 @@ template <typename T> class LockFreeQueue
         T data;
     };
 
+    static constexpr bool kMultiProducer = Mode != QueueMode::SPSC;
+    static constexpr bool kMultiConsumer = Mode == QueueMode::MPMC;
+
     // 使用 alignas 避免伪共享
     alignas(64) std::atomic<size_t> enqueuePos_; // 入队位置
     alignas(64) std::atomic<size_t> dequeuePos_; // 出队位置
@@ -26,6 +45,9 @@ template <typename T> class LockFreeQueue
     static size_t roundUpToPowerOf2(size_t n); // 向上取整到2的幂
     static constexpr size_t kCacheLineSize = 64;
 
+    // 把位置从 pos 推进到 pos + n：多方一侧 CAS（失败时 pos 被更新为最新值），单方一侧直接写
+    template <bool Multi> static bool advance(std::atomic<size_t> &position, size_t &pos, size_t n);
+
     template <typename U> bool enqueueImpl(U &&data);
 
   public:
@@ -43,11 +65,20 @@ template <typename T> class LockFreeQueue
     bool enqueue(T &&data);
     bool dequeue(T &data);
 
+    // 批量入队 [first, first + count)：剩余空间不足时一个都不入队并返回 false
+    template <typename InputIt> bool enqueueBulk(InputIt first, size_t count);
+    // 批量出队最多 maxCount 个元素写入 out，返回实际出队数；只取已完成写入的连续一段
+    template <typename OutputIt> size_t dequeueBulk(OutputIt out, size_t maxCount);
+
     bool empty() const;
     size_t size() const; // 并发环境下只是近似大小
+    size_t capacity() const
+    {
+        return buffer_.size();
+    }
 };
 
-template <typename T> inline size_t LockFreeQueue<T>::roundUpToPowerOf2(size_t n)
+template <typename T, QueueMode Mode> inline size_t LockFreeQueue<T, Mode>::roundUpToPowerOf2(size_t n)
 {
     assert(n > 0);
     n--;
@@ -60,8 +91,8 @@ template <typename T> inline size_t LockFreeQueue<T>::roundUpToPowerOf2(size_t n
     return n + 1;
 }
 
-template <typename T>
-inline LockFreeQueue<T>::LockFreeQueue(size_t capacity)
+template <typename T, QueueMode Mode>
+inline LockFreeQueue<T, Mode>::LockFreeQueue(size_t capacity)
     : buffer_(roundUpToPowerOf2(capacity)), bufferMask_(buffer_.size() - 1), enqueuePos_(0), dequeuePos_(0)
 {
     // 初始化每个槽的序列号
@@ -71,7 +102,23 @@ inline LockFreeQueue<T>::LockFreeQueue(size_t capacity)
     }
 }
 
-template <typename T> template <typename U> inline bool LockFreeQueue<T>::enqueueImpl(U &&data)
+template <typename T, QueueMode Mode>
+template <bool Multi>
+inline bool LockFreeQueue<T, Mode>::advance(std::atomic<size_t> &position, size_t &pos, size_t n)
+{
+    if constexpr (Multi)
+    {
+        return position.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed);
+    }
+    else
+    {
+        // 只有本线程推进这个位置，其他线程只在 size()/empty() 中读取
+        position.store(pos + n, std::memory_order_relaxed);
+        return true;
+    }
+}
+
+template <typename T, QueueMode Mode> template <typename U> inline bool LockFreeQueue<T, Mode>::enqueueImpl(U &&data)
 {
     Slot *slot;
     size_t pos = enqueuePos_.load(std::memory_order_relaxed);
@@ -85,8 +132,8 @@ template <typename T> template <typename U> inline bool LockFreeQueue<T>::enqueu
 
         if (dif == 0)
         {
-            // 槽位可用，CAS 抢占该槽位
-            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            // 槽位可用，抢占该槽位（多生产者时 CAS）
+            if (advance<kMultiProducer>(enqueuePos_, pos, 1))
             {
                 break;
             }
@@ -108,17 +155,17 @@ template <typename T> template <typename U> inline bool LockFreeQueue<T>::enqueu
     return true;
 }
 
-template <typename T> inline bool LockFreeQueue<T>::enqueue(const T &data)
+template <typename T, QueueMode Mode> inline bool LockFreeQueue<T, Mode>::enqueue(const T &data)
 {
     return enqueueImpl(data);
 }
 
-template <typename T> inline bool LockFreeQueue<T>::enqueue(T &&data)
+template <typename T, QueueMode Mode> inline bool LockFreeQueue<T, Mode>::enqueue(T &&data)
 {
     return enqueueImpl(std::forward<T>(data));
 }
 
-template <typename T> inline bool LockFreeQueue<T>::dequeue(T &data)
+template <typename T, QueueMode Mode> inline bool LockFreeQueue<T, Mode>::dequeue(T &data)
 {
     Slot *slot;
     size_t pos = dequeuePos_.load(std::memory_order_relaxed);
@@ -132,8 +179,8 @@ template <typename T> inline bool LockFreeQueue<T>::dequeue(T &data)
 
         if (dif == 0)
         {
-            // 槽位有数据，CAS 抢占该槽位
-            if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            // 槽位有数据，抢占该槽位（多消费者时 CAS）
+            if (advance<kMultiConsumer>(dequeuePos_, pos, 1))
             {
                 break;
             }
@@ -155,14 +202,116 @@ template <typename T> inline bool LockFreeQueue<T>::dequeue(T &data)
     return true;
 }
 
-template <typename T> inline bool LockFreeQueue<T>::empty() const
+template <typename T, QueueMode Mode>
+template <typename InputIt>
+inline bool LockFreeQueue<T, Mode>::enqueueBulk(InputIt first, size_t count)
+{
+    if (count == 0)
+    {
+        return true;
+    }
+    if (count > buffer_.size())
+    {
+        return false;
+    }
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true)
+    {
+        // 从 pos 开始逐个确认槽位可写；这些槽在入队位置越过它们之前不会被其他生产者占用
+        size_t ready = 0;
+        while (ready < count)
+        {
+            size_t seq = buffer_[(pos + ready) & bufferMask_].sequence.load(std::memory_order_acquire);
+            if (seq != pos + ready)
+            {
+                break;
+            }
+            ++ready;
+        }
+        if (ready < count)
+        {
+            size_t seq = buffer_[(pos + ready) & bufferMask_].sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + ready) < 0)
+            {
+                return false; // 剩余空间不足
+            }
+            // 其他生产者已经越过 pos，重新读取入队位置
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+            continue;
+        }
+        // 一次原子操作预留整段位置
+        if (advance<kMultiProducer>(enqueuePos_, pos, count))
+        {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i, ++first)
+    {
+        Slot &slot = buffer_[(pos + i) & bufferMask_];
+        slot.data = *first;
+        slot.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    return true;
+}
+
+template <typename T, QueueMode Mode>
+template <typename OutputIt>
+inline size_t LockFreeQueue<T, Mode>::dequeueBulk(OutputIt out, size_t maxCount)
+{
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    size_t ready = 0;
+    while (true)
+    {
+        // 从 pos 开始数出已完成写入的连续槽位；遇到尚未写完的槽就停下，它之后的元素留给下一次
+        ready = 0;
+        while (ready < maxCount)
+        {
+            size_t seq = buffer_[(pos + ready) & bufferMask_].sequence.load(std::memory_order_acquire);
+            if (seq != pos + ready + 1)
+            {
+                break;
+            }
+            ++ready;
+        }
+        if (ready == 0)
+        {
+            if constexpr (kMultiConsumer)
+            {
+                // 可能是其他消费者刚取走了 pos，出队位置变化时重试
+                size_t latest = dequeuePos_.load(std::memory_order_relaxed);
+                if (latest != pos)
+                {
+                    pos = latest;
+                    continue;
+                }
+            }
+            return 0;
+        }
+        // 一次原子操作取走整段
+        if (advance<kMultiConsumer>(dequeuePos_, pos, ready))
+        {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < ready; ++i, ++out)
+    {
+        Slot &slot = buffer_[(pos + i) & bufferMask_];
+        *out = std::move(slot.data);
+        slot.sequence.store(pos + i + buffer_.size(), std::memory_order_release);
+    }
+    return ready;
+}
+
+template <typename T, QueueMode Mode> inline bool LockFreeQueue<T, Mode>::empty() const
 {
     size_t head = dequeuePos_.load(std::memory_order_relaxed);
     size_t tail = enqueuePos_.load(std::memory_order_relaxed);
     return head == tail;
 }
 
-template <typename T> inline size_t LockFreeQueue<T>::size() const
+template <typename T, QueueMode Mode> inline size_t LockFreeQueue<T, Mode>::size() const
 {
     size_t head = dequeuePos_.load(std::memory_order_relaxed);
     size_t tail = enqueuePos_.load(std::memory_order_relaxed);
@@ -21,6 +21,7 @@
 #include <thread>
 
 #include "LockFreeQueue.hpp"
+#include "LoopClock.hpp"
 
 /**
  * @brief 日志级别枚举
@@ -185,12 +186,12 @@ class Logger
     static std::atomic<LogLevel> minLevel_;   // 最小日志级别（原子操作，支持运行时修改）
 
     // === 实例成员 ===
-    Options options_;                                // 日志系统配置
-    std::unique_ptr<LockFreeQueue<LogEntry>> queue_; // 无锁队列（容量 65536）
-    std::thread worker_;                             // 后台处理线程
-    std::atomic_bool running_;                       // 运行标志（控制后台线程退出）
-    std::ofstream logFile_;                          // 日志文件流
-    size_t currentFileSize_;                         // 当前日志文件大小（字节）
+    Options options_;                                                 // 日志系统配置
+    std::unique_ptr<LockFreeQueue<LogEntry, QueueMode::MPSC>> queue_; // 无锁队列（容量 65536，后台线程单消费者）
+    std::thread worker_;                                              // 后台处理线程
+    std::atomic_bool running_;                                        // 运行标志（控制后台线程退出）
+    std::ofstream logFile_;                                           // 日志文件流
+    size_t currentFileSize_;                                          // 当前日志文件大小（字节）
 
     /**
      * @brief 时间戳缓存结构（性能优化）
@@ -299,8 +300,8 @@ void Logger::log(LogLevel level, const char *file, int line, const char *fmtStr,
     entry.file = file;                                          // 仅存储指针，不拷贝字符串
     entry.line = line;
 
-    // 获取微秒级时间戳
-    auto now = std::chrono::system_clock::now();
+    // 获取微秒级时间戳：Loop 线程使用本轮循环的时钟快照，不再每条日志读一次时钟
+    auto now = LoopClock::wallNow();
     auto us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
     entry.timestampUs = static_cast<uint64_t>(us);
 
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <time.h>
+
+#include <chrono>
+
+/**
+ * 每个 EventLoop 一个的时钟快照：每轮循环在 io_uring_wait_cqe 返回后读取一次单调时钟和墙上时钟，
+ * 本轮处理的所有事件共用这一次读数，代替热点路径上反复调用 steady_clock/system_clock::now()
+ *
+ * - 快照在所属线程中登记为 thread_local 的当前时钟，Logger 等不持有 EventLoop 的代码通过静态接口读取；
+ *   没有 EventLoop 的线程（主线程初始化阶段、计算线程池）回退为直接读系统时钟；
+ * - coarse 为 true 时使用 CLOCK_MONOTONIC_COARSE/CLOCK_REALTIME_COARSE，只读 vDSO 中的 jiffy 时间，
+ *   开销更小，但精度为一个调度 tick（通常 1~4ms）；
+ * - 快照在一轮批处理内不前进，处理耗时越长，读到的时间越滞后，需要精确计时（如分阶段耗时统计）的地方仍应直接读时钟。
+ */
+class LoopClock
+{
+  public:
+    explicit LoopClock(bool coarse = false);
+    ~LoopClock();
+
+    // 禁用拷贝和赋值
+    LoopClock(const LoopClock &) = delete;
+    LoopClock &operator=(const LoopClock &) = delete;
+
+    // 重新读取时钟（EventLoop 每轮循环调用一次）
+    void update() noexcept;
+
+    std::chrono::steady_clock::time_point monotonic() const noexcept
+    {
+        return monotonic_;
+    }
+    std::chrono::system_clock::time_point wall() const noexcept
+    {
+        return wall_;
+    }
+
+    // 把本快照登记为当前线程的时钟（EventLoop 构造时调用）
+    void attachToCurrentThread() noexcept;
+    // 取消登记（EventLoop 析构时调用）
+    void detachFromCurrentThread() noexcept;
+
+    // 当前线程 Loop 的快照，没有 Loop 的线程直接读系统时钟
+    static std::chrono::steady_clock::time_point monotonicNow() noexcept
+    {
+        return current_ ? current_->monotonic_ : std::chrono::steady_clock::now();
+    }
+    static std::chrono::system_clock::time_point wallNow() noexcept
+    {
+        return current_ ? current_->wall_ : std::chrono::system_clock::now();
+    }
+
+  private:
+    clockid_t monotonicId_;                           // CLOCK_MONOTONIC 或 CLOCK_MONOTONIC_COARSE
+    clockid_t wallId_;                                // CLOCK_REALTIME 或 CLOCK_REALTIME_COARSE
+    std::chrono::steady_clock::time_point monotonic_; // 单调时钟快照，与 Deadline 同一时钟
+    std::chrono::system_clock::time_point wall_;      // 墙上时钟快照，用于日志时间戳
+
+    static thread_local LoopClock *current_; // 当前线程的时钟快照
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cassert>
 #include <cstdint>
@@ -11,45 +13,181 @@
 constexpr size_t MEMORY_POOL_NUM = 64;
 constexpr size_t SLOT_BASE_SIZE = 8;
 constexpr size_t MAX_SLOT_SIZE = 512;
+// 线程本地缓存：每个大小类别最多缓存的字节数与槽数上下限，满了之后把一半归还给全局内存池
+constexpr size_t THREAD_CACHE_BYTES_PER_CLASS = 32 * 1024;
+constexpr size_t THREAD_CACHE_MIN_SLOTS = 16;
+constexpr size_t THREAD_CACHE_MAX_SLOTS = 256;
 
 struct Slot
 {
     Slot *next;
 };
 
+/**
+ * 单个大小类别的全局内存池，多线程无锁分配/释放
+ *
+ * - 空闲链表是 Treiber 栈：链表头是一个 64 位原子字，低 48 位为槽地址，高 16 位为每次修改递增的标签，
+ *   弹出时即使同一个槽被其他线程弹出又压回（ABA），标签不同 CAS 也会失败；
+ * - 当前内存块的剩余空间用 fetch_add 原子地切分，只有内存块耗尽、需要向 OS 申请新块时才加锁；
+ * - 内存块用 mmap 按块大小（2 的幂）对齐申请，槽地址按位与即可找到所属内存块；
+ * - release() 统计空闲链表中每个内存块的空闲槽数（占用率），把全部空闲的内存块从链表中摘除并
+ *   madvise(MADV_DONTNEED) 归还物理内存。虚拟地址保留（弹出时可能读到已被取走的槽的 next，地址必须保持可访问），
+ *   之后需要新块时优先复用。
+ */
 class MemoryPool
 {
 public:
+    struct Stats
+    {
+        size_t slotSize = 0;        // 槽大小
+        size_t blockSize = 0;       // 内存块大小
+        size_t blocks = 0;          // 占用物理内存的内存块数
+        size_t purgedBlocks = 0;    // 已归还物理内存、等待复用的内存块数
+        size_t liveSlots = 0;       // 已分配出去的槽数（含线程本地缓存中的槽）
+        size_t freeSlots = 0;       // 全局空闲链表中的槽数
+        size_t releasedBytes = 0;   // 累计归还给 OS 的字节数
+        double fragmentation = 0.0; // 内存块中未被已分配槽占用的比例：1 - live * slotSize / (blocks * blockSize)
+    };
+
     // BlockSize默认设计为4096字节是因为作系统页大小通常是 4KB，与页对齐可以提高内存访问效率，避免跨页访问导致的性能损失
     MemoryPool(size_t blockSize = 4096);
     ~MemoryPool();
 
-    void init(size_t slotSize); // 延迟初始化
+    // 延迟初始化；blockSize 为 0 时沿用构造时的大小，否则向上取整到 2 的幂
+    // hugePages 为 true 时对内存块 madvise(MADV_HUGEPAGE)，块大小不小于 2MB 时可以由透明大页承载
+    void init(size_t slotSize, size_t blockSize = 0, bool hugePages = false);
     void *allocate();           // 分配一个内存槽，返回槽指针
     void deallocate(void *p);   // 回收内存槽到空闲槽链表
+
+    // 批量接口，供线程本地缓存使用：一次原子操作切分/归还多个槽
+    // 取出最多 n 个槽，以 next 串成链表写入 head，返回实际取出的个数（内存不足时可能少于 n）
+    size_t allocateBatch(Slot *&head, size_t n);
+    // 归还以 head 开头、tail 结尾的 n 个槽组成的链表
+    void deallocateBatch(Slot *head, Slot *tail, size_t n);
+
+    // 归还全部空闲的内存块（保留 retainBlocks 个以应对下一次增长），返回归还的字节数
+    size_t release(size_t retainBlocks);
+    // 全局空闲链表中的槽占已切分槽的比例，用于判断是否值得 release
+    double freeRatio() const;
+    Stats getStats() const;
+
 private:
-    void allocateNewBlock();                     // 向OS申请一个新内存块
+    // 内存块头部，位于每个内存块的起始处
+    struct BlockHeader
+    {
+        BlockHeader *next;          // 内存块链表
+        std::atomic<uintptr_t> cur; // 下一个未使用的槽地址，fetch_add 切分（可能越过 end）
+        uintptr_t end;              // 最后一个槽的结束地址
+        size_t capacity;            // 块内槽数
+    };
+
+    static constexpr unsigned kTagShift = 48;
+    static constexpr uint64_t kPtrMask = (uint64_t(1) << kTagShift) - 1;
+    static Slot *ptrOf(uint64_t head)
+    {
+        return reinterpret_cast<Slot *>(head & kPtrMask);
+    }
+    static uint64_t nextTag(uint64_t head)
+    {
+        return ((head >> kTagShift) + 1) << kTagShift;
+    }
+
+    Slot *popFree();                       // 弹出一个空闲槽，空时返回 nullptr
+    void pushFree(Slot *head, Slot *tail); // 把 head..tail 链表压入空闲链表
+    Slot *takeAllFree();                   // 摘下整个空闲链表
+    // 从当前内存块切分最多 n 个槽，当前块耗尽时申请新块；返回实际切分的个数
+    size_t carve(Slot *&chain, size_t n);
+    // 当前块仍为 exhausted 时申请新块并切换（加锁），失败返回 false
+    bool allocateNewBlock(BlockHeader *exhausted);
+    void *mapBlock();                            // 按块大小对齐 mmap 一个内存块
     size_t padPointer(char *p, size_t slotSize); // 计算内存对齐
 
-    size_t blockSize_; // 内存块大小
-    size_t slotSize_;  // 槽大小
-    Slot *firstBlock_; // 指向内存池管理的首个内存块
-    Slot *curSlot_;    // 指向当前内存块中下一个未被使用过的槽
-    Slot *freeList_;   // 空闲槽链表头指针
-    Slot *lastSlot_;   // 当前内存块中最后能够存放元素的内存槽指针(超过该位置需申请新的内存块)
+    size_t blockSize_;                    // 内存块大小（2 的幂）
+    size_t slotSize_;                     // 槽大小
+    bool hugePages_ = false;              // 是否对内存块启用透明大页
+    BlockHeader *firstBlock_;             // 占用物理内存的内存块链表，仅在 mutexForBlock_ 保护下访问
+    BlockHeader *purgedBlocks_ = nullptr; // 已归还物理内存的内存块，仅在 mutexForBlock_ 保护下访问
+    std::atomic<BlockHeader *> curBlock_; // 正在切分的内存块
+    std::atomic<uint64_t> freeList_;      // 带标签的空闲链表头
+
+    // 统计（近似值，只用于观测和 release 的触发判断）
+    std::atomic<size_t> carvedSlots_{0};   // 从占用物理内存的内存块中切分出的槽数
+    std::atomic<size_t> freeSlots_{0};     // 全局空闲链表中的槽数
+    std::atomic<size_t> blockCount_{0};    // firstBlock_ 链表长度
+    std::atomic<size_t> purgedCount_{0};   // purgedBlocks_ 链表长度
+    std::atomic<size_t> releasedBytes_{0}; // 累计归还的字节数
+
+    mutable std::mutex mutexForBlock_; // 申请新内存块、release 时加锁
+};
+
+/**
+ * 线程本地缓存（magazine）：每个线程、每个大小类别一个 LIFO 空闲链表，挡在全局 MemoryPool 前面
+ *
+ * - 分配/释放先操作本线程的链表，不加锁，刚释放的槽在下一次分配时优先复用，缓存局部性好；
+ * - 链表为空时从全局内存池批量取一批（容量的一半），超过容量时批量归还一半，摊薄全局内存池上的原子操作与缓存行争用；
+ * - 缓存的槽借用槽本身的前 8 字节串成链表，不占用额外内存；
+ * - 线程退出时把缓存的槽全部归还给全局内存池，跨线程释放（A 分配、B 释放）只是进入 B 的缓存。
+ */
+class ThreadCache
+{
+public:
+    ThreadCache() = default;
+    ~ThreadCache();
+
+    // 禁用拷贝和赋值
+    ThreadCache(const ThreadCache &) = delete;
+    ThreadCache &operator=(const ThreadCache &) = delete;
+
+    void *allocate(size_t index);
+    void deallocate(void *p, size_t index);
+    // 把所有缓存的槽归还给全局内存池
+    void flushAll();
+
+    // 大小类别 index 的缓存容量（槽数）
+    static size_t capacityOf(size_t index);
 
-    std::mutex mutexForFreeList_; // 保证freeList_在多线程中操作的原子性
-    std::mutex mutexForBlock_;    // 保证内存块管理在多线程中操作的原子性
+private:
+    struct FreeList
+    {
+        Slot *head = nullptr;
+        size_t count = 0;
+    };
+
+    void refill(size_t index);
+    void flush(size_t index, size_t n); // 从链表头部归还 n 个槽
+
+    std::array<FreeList, MEMORY_POOL_NUM> lists_{};
 };
 
 class HashBucket
 {
 public:
+    // 各大小类别内存块大小与归还策略
+    struct Options
+    {
+        // 内存块大小 = clamp(2 的幂向上取整(槽大小 * slotsPerBlock), minBlockSize, maxBlockSize)
+        size_t slotsPerBlock = 1024;
+        size_t minBlockSize = 64 * 1024;
+        size_t maxBlockSize = 2 * 1024 * 1024;
+        bool hugePages = false;              // 对内存块启用透明大页（块大小达到 2MB 时生效）
+        size_t retainFreeBlocks = 1;         // trim 时每个类别保留的全部空闲内存块数
+        double trimFreeRatio = 0.5;          // 全局空闲槽占比达到该值的类别才执行 trim
+        bool profiling = false;              // 开启分配剖析（见 AllocProfiler），也可在运行中单独开关
+        size_t profileSampleInterval = 4096; // 剖析时每个线程每隔多少次分配采样一次调用栈，0 表示只计数
+    };
+
     static void initMemoryPool();
+    static void initMemoryPool(const Options &options);
+    // 内存压力策略：把空闲比例达到 trimFreeRatio 的类别中全部空闲的内存块归还给 OS，返回归还的字节数
+    // 适合由定时器周期调用；线程本地缓存中的槽不参与（可先在各线程调用 flushThreadCache）
+    static size_t trim();
+    static std::array<MemoryPool::Stats, MEMORY_POOL_NUM> getStats();
     // 单例模式
     static MemoryPool &getMemoryPool(int index); // 获取内存池接口
     static void *useMemory(size_t size);
     static void freeMemory(void *p, size_t size);
+    // 把当前线程缓存的槽归还给全局内存池（线程退出时会自动归还，长期空闲的线程可以主动调用）
+    static void flushThreadCache();
 
     template <typename T, typename... Args>
     friend T *newElement(Args &&...args); // 提供给用户在内存池分配的内存中创建对象的外部接口
@@ -58,7 +196,11 @@ public:
     friend void deleteElement(T *p); // 析构内存池分配的内存中的对象
 
 private:
-    static MemoryPool memoryPool[MEMORY_POOL_NUM]; // 设置为static，借助 C++11 的线程安全静态初始化保证只初始化一次
+    // 当前线程的缓存，线程退出、缓存已析构后返回 nullptr（此后的分配释放直接走全局内存池）
+    static ThreadCache *threadCache();
+
+    static MemoryPool memoryPool[MEMORY_POOL_NUM];
+    static Options options_; // 设置为static，借助 C++11 的线程安全静态初始化保证只初始化一次
 };
 
 template <typename T, typename... Args>
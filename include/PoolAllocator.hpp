@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "MemoryPool.hpp"
+
+/**
+ * 基于 HashBucket 的标准分配器：容器换一个类型参数即可从内存池分配
+ *
+ *   PooledVector<RecallCandidate> candidates;               // std::vector<RecallCandidate, PoolAllocator<...>>
+ *   PooledUnorderedMap<uint64_t, std::shared_ptr<Node>> map; // 节点走内存池
+ *   auto node = std::allocate_shared<Node>(PoolAllocator<Node>(), args...);
+ *
+ * - 不超过 MAX_SLOT_SIZE 的请求走线程本地缓存 + 大小类别内存池，更大的请求（如大数组、哈希表的桶数组）回退到 malloc；
+ * - 无状态：所有实例相等，容器之间可以任意移动、交换，跨线程释放同样安全；
+ * - 内存池的槽只保证 8 字节对齐，对齐要求更高的类型直接使用对齐版本的 operator new；
+ * - HashBucket::initMemoryPool 必须在第一次分配之前调用。
+ */
+template <typename T>
+class PoolAllocator
+{
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &) noexcept
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+        if constexpr (alignof(T) > alignof(Slot))
+        {
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        }
+        else
+        {
+            void *p = HashBucket::useMemory(n * sizeof(T));
+            if (!p)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(p);
+        }
+    }
+
+    void deallocate(T *p, size_t n) noexcept
+    {
+        if constexpr (alignof(T) > alignof(Slot))
+        {
+            ::operator delete(p, n * sizeof(T), std::align_val_t(alignof(T)));
+        }
+        else
+        {
+            HashBucket::freeMemory(p, n * sizeof(T));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &) const noexcept
+    {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &) const noexcept
+    {
+        return false;
+    }
+};
+
+// 常用容器的内存池版本
+template <typename T>
+using PooledVector = std::vector<T, PoolAllocator<T>>;
+
+using PooledString = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+using PooledUnorderedMap = std::unordered_map<Key, Value, Hash, KeyEqual, PoolAllocator<std::pair<const Key, Value>>>;
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+constexpr size_t ARENA_CHUNK_SIZE = 16 * 1024;  // 请求 arena 的块大小（含块头）
+constexpr size_t ARENA_CHUNK_CACHE_LIMIT = 256; // 每个 Loop 最多缓存的空闲块数（4MB）
+
+/**
+ * 请求 arena 的块池：每个 EventLoop 持有一个，并在所属线程中登记为 thread_local 的当前块池
+ *
+ * 块是统一大小、独立 malloc 的内存，从释放线程的块池回收：请求在 IO 线程创建 arena、在计算线程池继续分配，
+ * 最后回到 IO 线程析构，块最终都回到 IO Loop 的空闲链表。
+ * - 块池只在所属线程访问，不需要加锁；
+ * - 线程没有块池（如计算线程池、EventLoop 创建之前的主线程）时直接使用 malloc/free。
+ */
+class ArenaChunkPool
+{
+public:
+    ArenaChunkPool() = default;
+    ~ArenaChunkPool();
+
+    // 禁用拷贝和赋值
+    ArenaChunkPool(const ArenaChunkPool &) = delete;
+    ArenaChunkPool &operator=(const ArenaChunkPool &) = delete;
+
+    // 把本块池登记为当前线程的块池（EventLoop 构造时调用）
+    void attachToCurrentThread();
+    // 取消登记（EventLoop 析构时调用）
+    void detachFromCurrentThread();
+
+    // 取一个 ARENA_CHUNK_SIZE 大小的块 / 归还
+    static void *acquire();
+    static void release(void *chunk);
+
+    struct Stats
+    {
+        uint64_t acquired = 0;   // 取块次数
+        uint64_t cacheHits = 0;  // 从空闲链表命中的次数
+        uint64_t released = 0;   // 归还次数（含其他线程取出、在本线程归还的块）
+        size_t cachedChunks = 0; // 空闲链表中的块数
+    };
+    const Stats &getStats() const { return stats_; }
+
+private:
+    struct FreeChunk
+    {
+        FreeChunk *next;
+    };
+
+    void *acquireChunk();
+    void releaseChunk(void *chunk);
+
+    FreeChunk *freeList_ = nullptr; // 空闲块链表
+    Stats stats_;
+
+    static thread_local ArenaChunkPool *current_; // 当前线程的块池
+};
+
+/**
+ * 请求级单调分配器（std::pmr::memory_resource）：一个请求期间的临时对象（召回候选、排序结果、
+ * RecommendItem 的字符串、响应 JSON 等）都从块内按指针递增分配，请求结束时整体释放
+ *
+ *   RequestArena arena;
+ *   std::pmr::vector<RecallCandidate> candidates(&arena);
+ *   std::pmr::string json(&arena);
+ *   // arena 析构（或 reset）时所有块一次性归还块池，单个对象的 deallocate 是空操作
+ *
+ * - 构造时即从当前线程的块池取第一个块，在 IO 线程创建、转到计算线程池使用的 arena 首块仍来自 IO Loop；
+ * - 超过块容量 1/4 的大请求单独 malloc 一块，不占用当前块的剩余空间，释放时直接 free，不进入块池；
+ * - 只能由一个线程同时使用，且必须比从它分配的所有容器活得更久。
+ */
+class RequestArena : public std::pmr::memory_resource
+{
+public:
+    RequestArena();
+    ~RequestArena() override;
+
+    // 禁用拷贝和赋值
+    RequestArena(const RequestArena &) = delete;
+    RequestArena &operator=(const RequestArena &) = delete;
+
+    // 释放全部分配，只保留第一个块，供同一连接上的下一个请求复用
+    void reset();
+
+    size_t bytesAllocated() const { return bytesAllocated_; } // 累计分配的字节数
+    size_t chunkCount() const { return chunkCount_; }         // 当前持有的块数（含大块）
+
+private:
+    struct ChunkHeader
+    {
+        ChunkHeader *next; // 块链表，头部为最新的块
+        size_t size;       // 块总大小，等于 ARENA_CHUNK_SIZE 的来自块池
+    };
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {} // 单调分配：逐个释放是空操作
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    // 当前块放不下：取新块（或为大请求单独分配）后再分配
+    void *allocateSlow(size_t bytes, size_t alignment);
+    void pushChunk(ChunkHeader *chunk);
+    static void releaseChunk(ChunkHeader *chunk);
+
+    ChunkHeader *chunks_ = nullptr; // 持有的块
+    ChunkHeader *first_ = nullptr;  // 构造时取得的第一个块，reset 时保留
+    char *cur_ = nullptr;           // 当前块的分配位置
+    char *end_ = nullptr;           // 当前块的末尾
+    size_t bytesAllocated_ = 0;
+    size_t chunkCount_ = 0;
+};
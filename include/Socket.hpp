@@ -47,6 +47,7 @@ public:
     void closeFd();
 
     void reset(); // 重置Socket对象，防止复用内存池中的内存时还残留上一个Socket的脏数据
+    void assign(int sockfd); // 复用 Socket 对象时绑定新的 fd（原 fd 若未关闭则先关闭）
 
 private:
     int sockfd_; // socket 文件描述符
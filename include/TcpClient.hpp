@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Connector.hpp"
+#include "CoroutineTask.hpp"
+#include "Deadline.hpp"
+#include "InetAddress.hpp"
+
+class EventLoop;
+class TcpConnection;
+
+/**
+ * 下游服务的客户端连接池：按对端地址分组缓存空闲连接，每个 EventLoop 一个，只在所属 Loop 线程使用（无锁）
+ *
+ *   ConnectResult r = co_await client.acquire(featureAddr, deadlineAfter(20ms));
+ *   if (!r) { ... }                            // 连接失败或截止时间到期
+ *   co_await r.conn->asyncSend(request, deadline);
+ *   int n = co_await r.conn->asyncRead(4096, deadline);
+ *   ...                                        // 读完整个响应
+ *   client.release(std::move(r.conn), n > 0);  // 归还；出错时传 false，连接被关闭而不是放回池中
+ *
+ * - 取出空闲连接前做健康检查：连接状态、无在途请求、MSG_PEEK 探测对端是否已关闭或残留了未读数据；
+ * - 每个地址最多缓存 maxIdlePerHost 个空闲连接，超出时关闭最久未用的一个；
+ * - 空闲超过 maxIdleTime 的连接在下一次访问该地址时关闭（不额外占用定时器）；
+ * - 优先复用最近归还的连接（LIFO），让不常用的连接自然老化。
+ */
+class TcpClient
+{
+  public:
+    struct Options
+    {
+        size_t maxIdlePerHost = 16;                   // 每个地址最多缓存的空闲连接数，0 表示不缓存
+        std::chrono::milliseconds maxIdleTime{30000}; // 空闲连接的最长存活时间
+    };
+
+    struct Stats
+    {
+        uint64_t reused = 0;        // 复用空闲连接的次数
+        uint64_t connected = 0;     // 新建连接成功的次数
+        uint64_t connectFailed = 0; // 新建连接失败的次数（含截止时间到期）
+        uint64_t evicted = 0;       // 健康检查失败或空闲超时被关闭的空闲连接数
+        uint64_t discarded = 0;     // 归还时不可复用或超出缓存上限被关闭的连接数
+        size_t idle = 0;            // 当前空闲连接数
+    };
+
+    explicit TcpClient(EventLoop *loop);
+    TcpClient(EventLoop *loop, const Options &options);
+    // 关闭所有空闲连接，需在所属 Loop 线程析构
+    ~TcpClient();
+
+    // 禁用拷贝和赋值
+    TcpClient(const TcpClient &) = delete;
+    TcpClient &operator=(const TcpClient &) = delete;
+
+    // 取得一个到 addr 的连接：优先复用通过健康检查的空闲连接，否则在截止时间内新建
+    Task<ConnectResult> acquire(InetAddress addr, Deadline deadline = kNoDeadline);
+    // 归还连接：reusable 为 false、连接已断开、仍有在途请求或未发完的数据时直接关闭
+    // 调用方必须已读完上一个响应，否则残留数据会在下一次取出时被健康检查发现并关闭
+    void release(std::shared_ptr<TcpConnection> conn, bool reusable = true);
+    // 关闭所有空闲连接
+    void closeIdle();
+
+    Stats getStats() const;
+
+  private:
+    struct IdleConnection
+    {
+        std::shared_ptr<TcpConnection> conn;         // 空闲连接
+        std::chrono::steady_clock::time_point since; // 归还时间
+    };
+    using IdleList = std::vector<IdleConnection>; // 按归还时间从旧到新排列
+
+    // 空闲连接是否可以复用
+    static bool isHealthy(const TcpConnection &conn);
+    // 关闭 list 头部空闲超时的连接
+    void evictExpired(IdleList &list, std::chrono::steady_clock::time_point now);
+
+    EventLoop *loop_;
+    Options options_;
+    std::unordered_map<std::string, IdleList> idle_; // key 为对端的 ip:port
+    Stats stats_;
+};
@@ -3,12 +3,16 @@
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <vector>
 
 #include "AsyncRead.hpp"
+#include "AsyncRelay.hpp"
 #include "AsyncWrite.hpp"
 #include "Buffer.hpp"
 #include "CoroutineTask.hpp"
+#include "Deadline.hpp"
 #include "EventLoop.hpp"
+#include "IdleTimingWheel.hpp"
 #include "InetAddress.hpp"
 #include "IoContext.hpp"
 #include "Logger.hpp"
@@ -91,6 +95,12 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
 
     // 重置TcpConnection，防止复用内存池中的内存时还残留上一个TcpConnection的脏数据
     void reset();
+    // 对象池复用：在 reset 之后为新连接重新初始化（保留 Buffer 容量与 IoContext 对象）
+    void reinit(const std::string &name, EventLoop *loop, int sockfd, const InetAddress &peerAddr);
+    // 是否还有以本连接 IoContext 为 user_data 的请求在途
+    bool hasInflightIo() const;
+    // 为所有在途请求提交异步取消（对象归还对象池前调用，促使迟到的 CQE 尽快到达）
+    void cancelInflightIo();
 
     // 获取所属的 EventLoop
     EventLoop *getLoop() const
@@ -110,6 +120,12 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
         return peerAddr_;
     }
 
+    // 获取底层 socket fd（供 Splice 中继作为目标 fd 使用）
+    int getFd() const
+    {
+        return socket_.getFd();
+    }
+
     // 获取连接名称
     const std::string &getName() const
     {
@@ -126,9 +142,29 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
     // 断开连接处理函数
     void handleClose();
 
+    // 优雅关闭（由 TcpServer::drain 在所属 Loop 调用）
+    // 标记连接进入排空状态；此时若连接正在请求边界上空闲读，直接取消该读请求，协程以 -ECANCELED 恢复后自行关闭连接
+    // 返回是否取消了空闲读
+    bool beginDrain();
+    // 排空截止时间已到：取消所有在途请求，挂起在本连接 IO 上的协程全部以 -ECANCELED 恢复，然后关闭连接
+    void abortDrain();
+    // 连接所在的服务器是否正在排空：业务协程应在处理完当前请求后关闭连接，不再等待下一个请求
+    bool isDraining() const
+    {
+        return draining_.load(std::memory_order_acquire);
+    }
+    // 业务协程在每次读之前标记：true 表示处于请求边界（没有读了一半的请求），这次读只是在等待下一个请求
+    // 只有处于请求边界上的读会在排空开始时被立即取消，读了一半的请求可以在截止时间前继续读完
+    void setAwaitingRequest(bool on)
+    {
+        awaitingRequest_ = on;
+    }
+
     // 提交异步读写操作到io_uring
-    void submitReadRequest(size_t nbytes);
-    void submitReadRequestWithUserBuffer(char *userBuf, size_t userBufCap, size_t nbytes);
+    // deadline 不为 kNoDeadline 时链接绝对时间的 LINK_TIMEOUT，与连接级读超时同时设置时取先到期的一个
+    void submitReadRequest(size_t nbytes, Deadline deadline = kNoDeadline);
+    void submitReadRequestWithUserBuffer(char *userBuf, size_t userBufCap, size_t nbytes,
+                                         Deadline deadline = kNoDeadline);
     void submitWriteRequest();
     void submitWriteRequestWithRegBuffer(void *buf, size_t len, int idx);
     void submitSendfileRequest(int in_fd, off_t offset, size_t count);
@@ -137,6 +173,24 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
 
     // 设置超时时间
     void setTimeout(std::chrono::milliseconds timeout);
+    // 设置空闲超时：连接建立后由所属 Loop 的时间轮跟踪，超过 timeout 没有读到数据时关闭连接
+    // 与 setTimeout 的区别是读请求不再链接 LINK_TIMEOUT，两者通常只设置其一
+    void setIdleTimeout(std::chrono::milliseconds timeout)
+    {
+        idleTimeout_ = timeout;
+    }
+    // 记录一次读活跃，只写入时间轮当前的 tick 值
+    void markActive()
+    {
+        if (idleTimingWheel_)
+        {
+            lastActiveTick_ = idleTimingWheel_->currentTick();
+        }
+    }
+    uint64_t getLastActiveTick() const
+    {
+        return lastActiveTick_;
+    }
 
     // 异步读写操作的协程接口，创建 Awaitable
     // 对象（这个Awaitable对象包含了读或写操作所需的所有参数），当使用co_await时会触发await_suspend提交io_uring请求
@@ -148,28 +202,56 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
     {
         return AsyncReadAwaitable(this, userBuf, userBufCap, len);
     };
+    // 带截止时间的读：到期仍未读到数据时返回 kDeadlineExceeded（-ETIMEDOUT），连接保持打开，由调用者决定后续处理
+    AsyncReadAwaitable asyncRead(size_t len, Deadline deadline)
+    {
+        return AsyncReadAwaitable(this, len, deadline);
+    };
+    AsyncReadAwaitable asyncRead(char *userBuf, size_t userBufCap, size_t len, Deadline deadline)
+    {
+        return AsyncReadAwaitable(this, userBuf, userBufCap, len, deadline);
+    };
     AsyncWriteAwaitable asyncWrite()
     {
         return AsyncWriteAwaitable(this);
     };
 
     // 发送数据
+    // 数据追加到 outputBuffer_ 后进入连接的有序写队列，多个协程可以同时 co_await asyncSend，
+    // 数据按调用顺序写入 socket，每个协程在自己的数据全部写完后恢复
+    // Cork 模式下只登记批处理结束时的合并提交，协程不挂起（除非触发 kBlock 背压）
     AsyncWriteAwaitable asyncSend(const std::string &data)
     {
-        checkOutputBufferBackpressure(data.size());
-        outputBuffer_.append(data);
-        return asyncWrite();
+        return asyncSend(data.data(), data.size());
     }
 
     AsyncWriteAwaitable asyncSend(const char *data, size_t len)
+    {
+        return asyncSend(data, len, kNoDeadline);
+    }
+
+    // 带截止时间的发送：写队列的写请求按所有等待者中最早的截止时间链接 LINK_TIMEOUT，
+    // 到期仍未写完时本次发送返回 kDeadlineExceeded；已追加的数据无法从字节流中撤回，仍会按顺序继续发送
+    // deadline 为 kNoDeadline 时即普通发送
+    AsyncWriteAwaitable asyncSend(const std::string &data, Deadline deadline)
+    {
+        return asyncSend(data.data(), data.size(), deadline);
+    }
+
+    AsyncWriteAwaitable asyncSend(const char *data, size_t len, Deadline deadline)
     {
         checkOutputBufferBackpressure(len);
         outputBuffer_.append(data, len);
-        return asyncWrite();
+        if (corking_)
+        {
+            scheduleFlush();
+        }
+        return AsyncWriteAwaitable(this, len, corking_, deadline);
     }
 
     // 固定缓冲区发送：直接从已注册缓冲区发送数据，不经过 outputBuffer_
     // 通常用于 Echo 、高性能网关代理等场景：读到的数据不需要解析
+    // 注意：固定缓冲区/Sendfile/零拷贝发送共用 writeContext_，同一时刻只允许一个在途，且不与写队列排序
     AsyncWriteAwaitable asyncSendRegisteredBuffer()
     {
         // 使用当前读缓冲区的数据直接发送
@@ -189,6 +271,79 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
         return AsyncWriteAwaitable(this, const_cast<char *>(data), len, true);
     }
 
+    // 链接式回显：一次提交 read_fixed + write_fixed 两个链接（IOSQE_IO_LINK）的 SQE，协程在写段完成后恢复
+    // 读写两段只需一次提交、一次协程恢复；len 不超过已注册缓冲区大小，本调用不使用读超时
+    // 注意：链接只在读段读满 len 时才执行写段，短读时写段被内核以 -ECANCELED 取消，
+    // 此时会自动补交一次写请求发送实际读到的数据，因此定长帧的场景收益最大
+    // 返回回显的字节数；读到 EOF 返回 0；失败返回负的错误码
+    AsyncRelayAwaitable asyncEchoLinked(size_t len)
+    {
+        return AsyncRelayAwaitable(this, len);
+    }
+
+    // Splice 中继：socket -> 管道 -> dstFd 两段 splice 链接提交，数据只在内核中搬运，适用于 L4 代理
+    // 管道按连接懒创建，单次中继量受管道容量（默认 64KB）限制，超出部分留待下一次中继
+    AsyncRelayAwaitable asyncSpliceTo(int dstFd, size_t len)
+    {
+        return AsyncRelayAwaitable(this, dstFd, len);
+    }
+
+    // 提交链接式中继（dstFd < 0 为回显模式），同一时刻最多一个在途；失败时返回 false 且结果可由 getRelayResult 取得
+    bool submitLinkedRelay(int dstFd, size_t len, std::coroutine_handle<> handle);
+    // 取消在途的链接式中继（读段与写段）
+    void cancelLinkedRelay()
+    {
+        if (relayInFlight_)
+        {
+            relayCancelled_ = true;
+            loop_->cancelIo(&relayInContext_);
+            loop_->cancelIo(&relayOutContext_);
+        }
+    }
+    int getRelayResult() const
+    {
+        return relayResult_;
+    }
+    bool isRelayInFlight() const
+    {
+        return relayInFlight_;
+    }
+
+    // 写合并（Cork）模式：开启后 asyncSend 不再逐次提交写请求，
+    // 同一轮事件循环内追加的数据、以及上一次写请求在途期间追加的数据，都会被合并为下一次的单个写请求
+    // 适用于 HTTP keep-alive / RPC 流水线场景，应在连接开始收发数据前设置（通常在连接回调中）
+    void setCorking(bool on);
+    bool isCorking() const
+    {
+        return corking_;
+    }
+    // 立即提交写队列中积压的数据（Cork 模式下不等待本轮批处理结束）
+    void flush();
+    // 尚未写入 socket 的字节数（包含在途写请求的部分）
+    size_t pendingOutputBytes() const
+    {
+        return outputBuffer_.readableBytes() + flushingBuffer_.readableBytes();
+    }
+    // 自连接建立以来已写入 socket 的总字节数，写队列中的等待者以此作为进度判断
+    uint64_t getBytesWritten() const
+    {
+        return bytesWritten_;
+    }
+    bool isOutputWriteInFlight() const
+    {
+        return outputWriteInFlight_;
+    }
+    // 写请求在途，或已登记在批处理结束时提交（含 SQ 满后的重试）
+    bool isOutputWritePending() const
+    {
+        return outputWriteInFlight_ || flushScheduled_;
+    }
+    // 挂起协程直到已写入总字节数达到 target、写请求失败或 deadline 到期；result 用于回填触发恢复的写结果
+    void waitOutputWritten(std::coroutine_handle<> handle, uint64_t target, int *result,
+                           Deadline deadline = kNoDeadline);
+    // 撤销尚未挂起的等待（写请求未能提交时）
+    void removeOutputWaiter(int *result);
+
     // 提供获取IoContext的接口
     IoContext &getReadContext()
     {
@@ -302,9 +457,39 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
     }
 
   private:
+    // 把 SQE 绑定到本连接的 IoContext，并计入在途请求数
+    void bindSqe(struct io_uring_sqe *sqe, IoContext &ctx)
+    {
+        io_uring_sqe_set_data(sqe, &ctx);
+        ++ctx.inflight;
+    }
+
     // 背压检查：检查 outputBuffer 是否超过高水位，执行相应策略
     void checkOutputBufferBackpressure(size_t incomingBytes);
 
+    // Cork 模式：登记批处理结束时的合并提交（每轮最多登记一次）
+    void scheduleFlush();
+    // 写队列：把 outputBuffer_ 中积压的数据作为一个写请求提交（同一时刻最多一个在途）
+    void submitOutputWrite();
+    // 写队列：写请求完成回调
+    void handleOutputWrite(int res);
+    // 写队列：恢复进度已满足、截止时间已到（或写失败时全部）的等待协程
+    void resumeOutputWaiters(int res, bool failed);
+    // 写队列：等待者中最早的截止时间
+    Deadline earliestOutputDeadline() const;
+    // 读请求链接超时：连接级读超时（到期关闭连接）或本次读的截止时间，取先到期的一个
+    void linkReadTimeout(struct io_uring_sqe *sqe, Deadline deadline);
+
+    // 链接式中继：准备写段 SQE（offset 为本次中继数据中已写出的字节数）
+    void prepRelayWrite(struct io_uring_sqe *sqe, size_t offset, size_t len);
+    // 链接式中继：读段/写段 CQE 到达后的汇总处理
+    void handleRelayCompletion();
+    // 链接式中继：结束本次中继并恢复等待的协程
+    void finishRelay(int res);
+    // Splice 中继管道的创建与关闭
+    bool ensureRelayPipe();
+    void closeRelayPipe();
+
     EventLoop *loop_;                       // 所属的 子EventLoop
     Socket socket_;                         // 连接的Socket对象
     std::atomic<TcpConnectionState> state_; // 连接状态
@@ -316,11 +501,21 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
 
     bool reading_; // 是否处于读状态
 
+    // 优雅关闭
+    std::atomic_bool draining_{false}; // 所在服务器是否正在排空（业务协程可能在计算线程上读取）
+    bool awaitingRequest_ = false;     // 当前读是否处于请求边界
+    bool drainAborted_ = false;        // 排空截止时间已到、在途请求已被取消（写队列不再重新提交）
+
     IoContext readContext_;                 // 读操作的上下文
     IoContext writeContext_;                // 写操作的上下文
     IoContext timeoutContext_;              // 超时操作的上下文
     std::chrono::milliseconds readTimeout_; // 读超时时间
     __kernel_timespec readTimeoutSpec_;     // 读超时的内核时间结构体
+    IoContext readDeadlineContext_;         // 读截止时间 LINK_TIMEOUT 的上下文（只计数，不处理结果）
+    __kernel_timespec readDeadlineSpec_{};  // 读截止时间的绝对时间结构体
+    std::chrono::milliseconds idleTimeout_{0};   // 空闲超时时间（时间轮模式），0 表示不启用
+    IdleTimingWheel *idleTimingWheel_ = nullptr; // 跟踪本连接的时间轮（所属 Loop 的）
+    uint64_t lastActiveTick_ = 0;                // 最近一次读活跃时的时间轮 tick
 
     // 存储当前读操作使用的输入缓冲区信息，可以为固定缓冲区也可以为用户提供的缓冲区
     void *curReadBuffer_;        // 当前读缓冲区指针
@@ -328,13 +523,50 @@ class TcpConnection : public std::enable_shared_from_this<TcpConnection>
     size_t curReadBufferOffset_; // 当前读缓冲区的偏移位置
     Buffer outputBuffer_;        // 发送缓冲区
 
+    // 有序写队列：outputBuffer_ 上的所有发送按追加顺序串行写入，同一时刻最多一个写请求在途
+    struct OutputWaiter
+    {
+        std::coroutine_handle<> handle; // 等待的协程
+        uint64_t target;                // bytesWritten_ 达到该值时恢复
+        int *result;                    // 回填写结果（位于协程帧中的 Awaitable 内）
+        Deadline deadline;              // 截止时间，到期未写完时以 kDeadlineExceeded 恢复
+    };
+    bool outputWriteInFlight_ = false;           // 是否有写请求在途
+    Buffer flushingBuffer_;                      // 在途写请求引用的数据，提交时与 outputBuffer_ 交换，防止追加导致内存搬移
+    IoContext outputContext_;                    // 写队列写请求的上下文（回调模式）
+    uint64_t bytesWritten_ = 0;                  // 已写入 socket 的总字节数
+    std::vector<OutputWaiter> outputWaiters_;    // 等待写进度的协程（单线程访问）
+    std::vector<OutputWaiter> readyWaiters_;     // 恢复阶段的临时列表，复用容量
+    Deadline outputWriteDeadline_ = kNoDeadline; // 在途写请求链接的截止时间（或为更早的截止时间发起取消时的值）
+    IoContext outputDeadlineContext_;            // 写截止时间 LINK_TIMEOUT 的上下文（只计数，不处理结果）
+    __kernel_timespec outputDeadlineSpec_{};     // 写截止时间的绝对时间结构体
+
+    // 链接式中继（read_fixed->write_fixed / splice->splice），同一时刻最多一个在途
+    IoContext relayInContext_;            // 读段上下文（回调模式），回显模式下 idx 为使用的已注册缓冲区
+    IoContext relayOutContext_;           // 写段上下文（回调模式）
+    std::coroutine_handle<> relayHandle_; // 等待中继完成的协程
+    bool relayInFlight_ = false;          // 是否有中继在途
+    bool relayLinked_ = false;            // 在途的写段是否为链接提交（只有链接写段的 -ECANCELED 表示短读断链）
+    bool relayCancelled_ = false;         // 本次中继是否已被取消（不再补交写段）
+    int relayPending_ = 0;                // 尚未收到 CQE 的段数
+    int relayDstFd_ = -1;                 // Splice 目标 fd，-1 表示回显模式
+    int relayInResult_ = 0;               // 读段结果
+    int relayOutResult_ = 0;              // 最近一次写段结果
+    size_t relayWritten_ = 0;             // 写段累计写出的字节数
+    int relayResult_ = 0;                 // 最终结果，由 AsyncRelayAwaitable 取回
+    int relayPipe_[2] = {-1, -1};         // Splice 中转管道，[0] 读端，[1] 写端
+
+    // 写合并（Cork）
+    bool corking_ = false;        // 是否开启 Cork 模式
+    bool flushScheduled_ = false; // 本轮是否已登记批处理结束提交
+
     // 背压管理
     BackpressureConfig backpressureConfig_;   // 背压配置
     OutputBufferStats outputBufferStats_;     // 统计信息
     std::atomic_bool inHighWaterMark_{false}; // 是否处于高水位
 
-    const InetAddress localAddr_; // 本地地址
-    const InetAddress peerAddr_;  // 对端地址，保存下来以免频繁调用
+    InetAddress localAddr_; // 本地地址（对象池复用时重新赋值）
+    InetAddress peerAddr_;  // 对端地址，保存下来以免频繁调用
 
     // 回调函数对象
     ConnectionCallback connectionCallback_;
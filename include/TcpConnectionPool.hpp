@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class EventLoop;
+class InetAddress;
+class TcpConnection;
+
+/**
+ * 每个 EventLoop 一个的 TcpConnection 对象池
+ *
+ * 连接关闭后对象不析构，而是 reset 后放回空闲列表，下一次 accept 时直接 reinit 复用，
+ * 保留 outputBuffer_/flushingBuffer_ 的容量、写队列 vector 的容量以及各个 IoContext 对象。
+ * 对外仍然返回 std::shared_ptr<TcpConnection>（业务接口不变），但：
+ * - 删除器把对象交还对象池而不是 delete；
+ * - 控制块通过内存池分配，accept 路径上不再有堆分配。
+ *
+ * 复用安全：IoContext 是 io_uring 的 user_data，对象仍有请求在途时不能复用，
+ * 否则迟到的 CQE 会被分发给下一个连接。释放的对象先进入等待区（有在途请求的同时提交取消），
+ * 在批处理结束时检查，所有 CQE 到达后（IoContext::inflight 归零）才 reset 并放回空闲列表。
+ *
+ * 线程模型：acquire 可在任意线程调用（通常是主 Loop 的 accept 路径），回收总是在所属 Loop 线程执行。
+ */
+class TcpConnectionPool : public std::enable_shared_from_this<TcpConnectionPool>
+{
+  public:
+    TcpConnectionPool(EventLoop *loop, size_t capacity);
+    ~TcpConnectionPool();
+
+    // 禁用拷贝和赋值
+    TcpConnectionPool(const TcpConnectionPool &) = delete;
+    TcpConnectionPool &operator=(const TcpConnectionPool &) = delete;
+
+    // 取出一个连接对象（优先复用），最后一个 shared_ptr 释放时对象自动回到对象池
+    std::shared_ptr<TcpConnection> acquire(const std::string &name, int sockfd, const InetAddress &peerAddr);
+
+    // 所属 EventLoop 析构时调用：之后释放的连接对象直接析构
+    void detach();
+
+    struct Stats
+    {
+        uint64_t created = 0;  // 新建的对象数
+        uint64_t reused = 0;   // 复用的对象数
+        uint64_t recycled = 0; // 放回空闲列表的对象数
+        uint64_t deferred = 0; // 释放时仍有请求在途、需要先取消的次数
+        uint64_t dropped = 0;  // 超出容量被直接析构的对象数
+        size_t cached = 0;     // 当前空闲对象数
+    };
+    Stats getStats();
+
+  private:
+    // shared_ptr 删除器：把对象交还对象池
+    struct Recycler
+    {
+        std::shared_ptr<TcpConnectionPool> pool;
+        void operator()(TcpConnection *conn) const;
+    };
+
+    // 在所属 Loop 线程回收对象
+    void release(TcpConnection *conn);
+    // reset 并放入空闲列表（超出容量时析构）
+    void recycle(TcpConnection *conn);
+    // 检查等待区，在途请求已全部完成的对象回收
+    void reapRetiring();
+    void scheduleReap();
+
+    EventLoop *loop_;
+    const size_t capacity_; // 空闲列表上限，0 表示不缓存（仍保留在途请求的等待保护）
+
+    std::mutex mutex_;                      // 保护 free_ 与 stats_
+    std::vector<TcpConnection *> free_;     // 空闲对象
+    Stats stats_;                           // 统计信息
+    std::vector<TcpConnection *> retiring_; // 等待回收的对象，仅 Loop 线程访问
+    bool reapScheduled_ = false;            // 是否已登记批处理结束时的检查，仅 Loop 线程访问
+    std::atomic_bool detached_{false};      // 所属 EventLoop 是否已析构
+};
@@ -23,11 +23,29 @@
  * 提供设置连接回调、消息回调等接口
  */
 
+// 空闲连接的超时机制
+enum class IdleTimeoutMode
+{
+    kLinkTimeout, // 每次读请求链接一个 IORING_OP_LINK_TIMEOUT：精确的单次读超时，但每次读多占一个 SQE 和一个内核定时器
+    kTimingWheel  // 每个 Loop 一个哈希时间轮，单个周期 tick 批量关闭空闲连接：开销低，精度为一个 tick
+};
+
 class TcpServer
 {
   public:
     using ConnectionCallback = std::function<void(const std::shared_ptr<TcpConnection> &)>;
 
+    // 优雅关闭的结果统计
+    struct DrainStats
+    {
+        size_t total = 0;                     // 开始排空时的连接数
+        size_t idleClosed = 0;                // 开始时正在空闲读、读请求被立即取消的连接数
+        size_t drained = 0;                   // 截止时间前处理完请求、自行关闭的连接数
+        size_t cancelled = 0;                 // 截止时间到达时仍未关闭、被取消在途请求并强制关闭的连接数
+        std::chrono::milliseconds elapsed{0}; // 从开始排空到全部连接移除的耗时
+    };
+    using DrainCallback = std::function<void(const DrainStats &)>;
+
     TcpServer(EventLoop *loop, const InetAddress &listenAddr, const std::string &name = "TcpServer");
     ~TcpServer();
     // 禁用拷贝和赋值
@@ -44,15 +62,49 @@ class TcpServer
     {
         readTimeout_ = timeout;
     }
+    // 设置空闲超时机制，超时时间沿用 setReadTimeout 的值
+    void setIdleTimeoutMode(IdleTimeoutMode mode)
+    {
+        idleTimeoutMode_ = mode;
+    }
+    // 设置新连接是否开启写合并（Cork）模式
+    void setWriteCorking(bool on)
+    {
+        writeCorking_ = on;
+    }
     // 设置新连接回调函数
     void setConnectionCallback(const TcpConnection::ConnectionCallback &cb)
     {
         connectionCallback_ = cb;
     }
 
+    /**
+     * 优雅关闭（排空），可在任意线程调用，只生效一次：
+     * 1. 停止监听，新连接由内核拒绝，滚动发布时同端口（SO_REUSEPORT）的新进程可以立即接管；
+     * 2. 所有连接标记为排空状态（TcpConnection::isDraining），正在请求边界上空闲读的连接直接取消读请求，
+     *    处理中的请求可以继续执行到 timeout，业务协程应在响应发出后关闭连接；
+     * 3. timeout 到达时仍未关闭的连接，用 IORING_OP_ASYNC_CANCEL 取消全部在途请求，
+     *    挂起的协程以 -ECANCELED 恢复（已注册缓冲区随之归还、协程帧正常结束），连接随后被强制关闭；
+     * 4. 全部连接移除后在主 Loop 线程调用 cb，通常在 cb 中调用 loop->quit()。
+     * 排空进行中（cb 被调用之前）不能析构 TcpServer。
+     */
+    void drain(std::chrono::milliseconds timeout, DrainCallback cb);
+
   private:
+    // 排空阶段，仅主 Loop 线程访问
+    enum class DrainPhase
+    {
+        kNone,     // 未开始
+        kDraining, // 等待连接自行关闭，截止定时器在途
+        kAborting, // 截止时间已到，等待被强制关闭的连接移除
+        kDone      // 已完成并回调
+    };
+
     void newConnection(int sockfd, const InetAddress &peerAddr);       // 新连接到来时的回调函数
     void removeConnection(const std::shared_ptr<TcpConnection> &conn); // 连接断开时的回调函数
+    void startDrain(std::chrono::milliseconds timeout, DrainCallback cb); // 在主 Loop 线程开始排空
+    void handleDrainTimeout(int res);                                     // 排空截止定时器到期
+    void finishDrain();                                                   // 全部连接已移除，回调统计结果
 
     EventLoop *loop_;                       // 主线程的 EventLoop 对象，负责监听和接受新连接
     const std::string name_;                // 服务器名称
@@ -67,4 +119,15 @@ class TcpServer
         connections_; // 活动连接列表，key是连接名称，value是 TcpConnection 对象，使用shared_ptr保证连接在断开前不被析构
     EventLoopThreadPool threadPool_;              // 线程池，每个线程运行一个 EventLoop
     std::chrono::milliseconds readTimeout_{5000}; // 读超时时间
+    IdleTimeoutMode idleTimeoutMode_{IdleTimeoutMode::kLinkTimeout}; // 空闲超时机制
+    bool writeCorking_{false};                                        // 新连接是否开启写合并
+
+    // 优雅关闭
+    DrainPhase drainPhase_{DrainPhase::kNone};           // 排空阶段
+    DrainCallback drainCallback_;                        // 排空完成回调
+    DrainStats drainStats_;                              // 排空统计
+    std::atomic<size_t> drainIdleClosed_{0};             // 各 IO Loop 中被取消空闲读的连接数
+    std::chrono::steady_clock::time_point drainStart_;   // 开始排空的时间
+    IoContext drainTimerContext_{IoType::Timeout, -1};   // 排空截止定时器的上下文
+    __kernel_timespec drainTimeoutSpec_{};               // 排空截止定时器的时间结构体
 };
\ No newline at end of file
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <liburing.h>
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Deadline.hpp"
+#include "IoContext.hpp"
+
+class EventLoop;
+
+namespace detail
+{
+// 侵入式双向循环链表节点，时间轮槽位的哨兵与定时器节点共用
+struct TimerListHook
+{
+    TimerListHook *prev = this;
+    TimerListHook *next = this;
+
+    bool empty() const noexcept
+    {
+        return next == this;
+    }
+    void pushBack(TimerListHook *node) noexcept
+    {
+        node->prev = prev;
+        node->next = this;
+        prev->next = node;
+        prev = node;
+    }
+    void unlink() noexcept
+    {
+        prev->next = next;
+        next->prev = prev;
+        prev = next = this;
+    }
+};
+} // namespace detail
+
+// 定时器标识：节点地址 + 序号，节点复用后旧标识自动失效，cancel 不会误删新定时器
+struct TimerId
+{
+    void *node = nullptr;
+    uint64_t seq = 0;
+
+    explicit operator bool() const noexcept
+    {
+        return node != nullptr;
+    }
+};
+
+/**
+ * 每个 EventLoop 一个的分层时间轮定时器（仅 Loop 线程访问）
+ *
+ * - 4 层时间轮（256 + 64 + 64 + 64 槽），tick 默认 1ms，一圈覆盖约 18.6 小时，更远的定时器在最高层轮转等待；
+ * - 添加/取消都是 O(1) 的链表操作，定时器节点按块分配并复用，不随定时器逐个 new/delete；
+ * - 整个时间轮只占用一个 io_uring timeout：按最近的到期时间（或需要降级的高层槽位）以绝对时间武装，
+ *   有更早的定时器加入时用 IORING_TIMEOUT_UPDATE 原地修改，而不是每个定时器一个内核定时器；
+ * - 到期回调在 Loop 线程执行，回调中可以再添加或取消定时器。
+ *
+ *   TimerQueue &timers = loop->getTimerQueue();
+ *   TimerId id = timers.runEvery(std::chrono::seconds(1), [] { sendHeartbeat(); });
+ *   timers.cancel(id);
+ *   co_await timers.sleepFor(std::chrono::milliseconds(50)); // 协程睡眠，不创建内核定时器
+ */
+class TimerQueue
+{
+  public:
+    using Functor = std::function<void()>;
+
+    // co_await timers.sleepFor(d)：到期后协程在 Loop 线程恢复
+    class SleepAwaitable
+    {
+      public:
+        SleepAwaitable(TimerQueue *queue, Deadline when) : queue_(queue), when_(when) {}
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+        // 提前结束等待（when_any 取消落败者时调用），协程在本轮批处理结束时恢复
+        void cancel() noexcept;
+
+      private:
+        TimerQueue *queue_;
+        Deadline when_;
+        TimerId id_;
+        std::coroutine_handle<> handle_;
+    };
+
+    struct Stats
+    {
+        uint64_t added = 0;     // 添加的定时器数
+        uint64_t fired = 0;     // 到期执行的次数（周期定时器每次计一次）
+        uint64_t cancelled = 0; // 到期前被取消的定时器数
+        uint64_t cascaded = 0;  // 从高层槽位降级重新放置的次数
+        uint64_t armed = 0;     // 提交内核 timeout（含原地更新）的次数
+        size_t active = 0;      // 当前未到期的定时器数
+    };
+
+    TimerQueue(EventLoop *loop, std::chrono::milliseconds tick);
+    ~TimerQueue();
+
+    // 禁用拷贝和赋值
+    TimerQueue(const TimerQueue &) = delete;
+    TimerQueue &operator=(const TimerQueue &) = delete;
+
+    // 在 when 时刻执行 cb（按 tick 向上取整），已过期的在下一个 tick 执行
+    TimerId runAt(Deadline when, Functor cb);
+    TimerId runAfter(std::chrono::nanoseconds delay, Functor cb);
+    // 每隔 interval 执行一次，首次在 interval 之后；回调执行较慢时不补发错过的周期
+    TimerId runEvery(std::chrono::nanoseconds interval, Functor cb);
+    // 取消定时器：返回是否在到期前取消成功；周期定时器可以在自己的回调中取消
+    bool cancel(TimerId id);
+
+    SleepAwaitable sleepUntil(Deadline when)
+    {
+        return SleepAwaitable(this, when);
+    }
+    SleepAwaitable sleepFor(std::chrono::nanoseconds duration);
+
+    size_t size() const noexcept
+    {
+        return size_;
+    }
+    Stats getStats() const
+    {
+        Stats stats = stats_;
+        stats.active = size_;
+        return stats;
+    }
+
+  private:
+    static constexpr int kLevels = 4;
+    static constexpr unsigned kLevelBits[kLevels] = {8, 6, 6, 6};
+    static constexpr unsigned kLevelShift[kLevels] = {0, 8, 14, 20};
+    static constexpr uint64_t kMaxSpan = uint64_t(1) << 26; // 时间轮一圈覆盖的 tick 数
+    static constexpr uint64_t kNoTick = UINT64_MAX;
+    static constexpr uint8_t kDetached = 0xff; // 节点不在任何槽位中（正在到期处理）
+    static constexpr size_t kChunkSize = 256;  // 节点按块分配的大小
+
+    struct TimerNode : detail::TimerListHook
+    {
+        uint64_t expire = 0;             // 到期 tick
+        uint64_t interval = 0;           // 周期 tick，0 表示单次
+        uint64_t seq = 0;                // 与 TimerId 比对，节点释放时递增
+        uint8_t level = kDetached;       // 所在层
+        uint16_t slot = 0;               // 所在槽位
+        bool running = false;            // 周期定时器的回调是否正在执行
+        bool cancelled = false;          // 是否在自己的回调中被取消
+        Functor cb;                      // 回调
+        std::coroutine_handle<> handle;  // 协程睡眠时直接恢复协程，不经过 std::function
+        TimerNode *nextFree = nullptr;   // 空闲链表
+    };
+
+    struct Level
+    {
+        std::vector<detail::TimerListHook> slots; // 槽位链表哨兵
+        std::vector<uint64_t> occupied;           // 非空槽位位图，用于快速查找下一个事件
+    };
+
+    TimerId add(Deadline when, uint64_t intervalTicks, Functor cb, std::coroutine_handle<> handle);
+    TimerNode *allocNode();
+    void freeNode(TimerNode *node);
+    // 按到期 tick 与当前 tick 的距离放入对应层的槽位
+    void place(TimerNode *node);
+    // 从槽位中摘下节点，槽位变空时清除位图
+    void detach(TimerNode *node);
+    // 下一个需要处理的 tick：最近的 0 层到期槽位，或最近的高层降级点；时间轮为空时返回 kNoTick
+    uint64_t nextEventTick() const;
+    // 推进到 target tick，依次降级高层槽位并执行到期的定时器
+    void advance(uint64_t target);
+    void cascade(int level, size_t slot);
+    void expire(size_t slot);
+    // 按最近的事件武装（或提前）内核 timeout
+    void rearm();
+    void handleTimeout(int res);
+
+    // 按 Loop 本轮循环的时钟快照计算当前 tick
+    uint64_t nowTick() const;
+    uint64_t toTick(Deadline when) const; // 向上取整
+
+    EventLoop *loop_;
+    std::chrono::nanoseconds tick_;                     // tick 间隔
+    std::chrono::steady_clock::time_point start_;       // tick 0 对应的时刻
+    Level levels_[kLevels];                             // 各层时间轮
+    uint64_t currentTick_ = 0;                          // 已处理到的 tick
+    size_t size_ = 0;                                   // 未到期的定时器数
+    std::vector<std::unique_ptr<TimerNode[]>> chunks_;  // 节点内存块
+    TimerNode *freeList_ = nullptr;                     // 空闲节点
+    IoContext timeoutContext_;                          // 内核 timeout 的上下文（回调模式）
+    struct __kernel_timespec armSpec_{};                // 武装的绝对到期时间，提交前可被更早的时间覆盖
+    bool armed_ = false;                                // 是否有内核 timeout 在途
+    uint64_t armedTick_ = kNoTick;                      // 在途 timeout 对应的 tick
+    Stats stats_;
+};
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "CoroutineTask.hpp"
+#include "FramePool.hpp"
+
+/**
+ * @file WhenAll.hpp
+ * 并发等待组合子：when_all / when_any
+ *
+ * 参数可以是 Task<T>，也可以是任意 Awaitable（asyncRead、AsyncSleepAwaitable 等）。
+ * 所有子操作都在当前 EventLoop 线程上依次启动并并发等待，父协程在以下时机恢复：
+ * - when_all：全部子操作完成；结果按参数顺序放在 tuple 中（void 结果为 std::monostate），
+ *   任一子操作抛出异常时，在全部完成后重新抛出第一个异常；
+ * - when_any：第一个子操作完成后，对仍在运行、且提供 cancel() 的落败者发起 io_uring 异步取消，
+ *   等所有已启动的子操作结束后恢复（子协程帧由组合子持有，必须等它们全部结束才能安全销毁）；
+ *   尚未启动的子操作不再启动。没有 cancel() 的落败者（如 Task<T>）会正常运行到结束，结果被丢弃。
+ *
+ * 注意：Awaitable 参数按引用保存，必须直接 co_await when_all(...) / when_any(...) 表达式本身，
+ * 不要把结果存为变量后再等待，否则作为参数的临时 Awaitable 已经析构。
+ */
+
+template <typename T>
+using WhenValue = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+// when_any 的结果：index 为最先完成的子操作下标，values 中该下标的结果一定存在，其余为落败者已得到的结果
+template <typename... Ts>
+struct WhenAnyResult
+{
+    size_t index;
+    std::tuple<std::optional<WhenValue<Ts>>...> values;
+};
+
+namespace detail
+{
+// 可被 when_any 取消的 Awaitable：提供 cancel()，调用后在途的 io_uring 请求以 -ECANCELED 尽快完成
+template <typename A>
+concept CancellableAwaitable = requires(A &a) { a.cancel(); };
+
+// when_all / when_any 的单个参数：Task<T> 或提供 await_resume() 的 Awaitable
+template <typename A>
+inline constexpr bool kIsTask = false;
+template <typename T>
+inline constexpr bool kIsTask<Task<T>> = true;
+
+template <typename A>
+concept WhenAwaitable = kIsTask<A> || requires(A &a) {
+    a.await_ready();
+    a.await_resume();
+};
+
+template <typename A>
+struct WhenChildTraits
+{
+    using ResultType = std::remove_cvref_t<decltype(std::declval<A &>().await_resume())>;
+};
+
+template <typename T>
+struct WhenChildTraits<Task<T>>
+{
+    using ResultType = T;
+};
+
+template <typename A>
+using WhenResultOf = typename WhenChildTraits<std::remove_cvref_t<A>>::ResultType;
+
+// 把 Awaitable 包装为惰性 Task，统一子操作的形式
+template <typename R, typename A>
+Task<R> awaitAsTask(A &awaitable)
+{
+    if constexpr (std::is_void_v<R>)
+    {
+        co_await awaitable;
+    }
+    else
+    {
+        co_return co_await awaitable;
+    }
+}
+
+template <typename A>
+Task<WhenResultOf<A>> makeWhenTask(A &&child)
+{
+    if constexpr (kIsTask<std::remove_cvref_t<A>>)
+    {
+        return std::move(child);
+    }
+    else
+    {
+        return awaitAsTask<WhenResultOf<A>>(child);
+    }
+}
+
+// 取消回调：无类型擦除开销的函数指针 + 对象指针
+struct WhenCanceller
+{
+    void (*fn)(void *) = nullptr;
+    void *target = nullptr;
+
+    void operator()() const
+    {
+        if (fn)
+        {
+            fn(target);
+        }
+    }
+};
+
+template <typename A>
+WhenCanceller makeWhenCanceller(A &child)
+{
+    if constexpr (CancellableAwaitable<A>)
+    {
+        return WhenCanceller{[](void *p) { static_cast<A *>(p)->cancel(); }, &child};
+    }
+    else
+    {
+        return WhenCanceller{};
+    }
+}
+
+// 组合子的共享计数：remaining 包含一个"启动中"占位，防止子操作在启动阶段同步完成时提前恢复父协程
+struct WhenState
+{
+    size_t remaining = 0;
+    std::coroutine_handle<> parent;
+};
+
+// 驱动单个子操作的协程：等待子 Task，记录结果/异常，通知组合子；最后一个结束的子协程对称转移回父协程
+class WhenChild
+{
+  public:
+    struct promise_type
+    {
+        WhenState *state = nullptr;
+
+        WhenChild get_return_object() { return WhenChild{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+            {
+                WhenState *state = handle.promise().state;
+                return --state->remaining == 0 ? state->parent : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); } // 子操作的异常已在协程体内捕获
+
+        // 协程帧从当前线程（EventLoop）的帧池分配
+        static void *operator new(size_t size) { return FramePool::allocate(size); }
+        static void operator delete(void *p, size_t size) { FramePool::deallocate(p, size); }
+    };
+
+    explicit WhenChild(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    WhenChild(WhenChild &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    WhenChild(const WhenChild &) = delete;
+    WhenChild &operator=(const WhenChild &) = delete;
+    WhenChild &operator=(WhenChild &&) = delete;
+    ~WhenChild()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    void start(WhenState *state)
+    {
+        handle_.promise().state = state;
+        ++state->remaining;
+        handle_.resume();
+    }
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename R, typename Owner>
+WhenChild runWhenChild(Owner *owner, size_t index, Task<R> &task, std::optional<WhenValue<R>> &slot,
+                       std::exception_ptr &error)
+{
+    try
+    {
+        if constexpr (std::is_void_v<R>)
+        {
+            co_await std::move(task);
+            slot.emplace();
+        }
+        else
+        {
+            slot.emplace(co_await std::move(task));
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    owner->childDone(index);
+}
+
+template <typename... Ts>
+class WhenAllAwaiter
+{
+  public:
+    explicit WhenAllAwaiter(Task<Ts>... tasks) : tasks_(std::move(tasks)...) {}
+    // 子协程引用本对象的成员，禁止移动
+    WhenAllAwaiter(const WhenAllAwaiter &) = delete;
+    WhenAllAwaiter &operator=(const WhenAllAwaiter &) = delete;
+
+    bool await_ready() const noexcept { return sizeof...(Ts) == 0; }
+    bool await_suspend(std::coroutine_handle<> parent)
+    {
+        state_.parent = parent;
+        state_.remaining = 1;
+        startAll(std::index_sequence_for<Ts...>{});
+        // 去掉启动占位：全部子操作已同步完成时不挂起
+        return --state_.remaining != 0;
+    }
+    std::tuple<WhenValue<Ts>...> await_resume()
+    {
+        for (const std::exception_ptr &error : errors_)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+        return takeValues(std::index_sequence_for<Ts...>{});
+    }
+
+    void childDone(size_t) {}
+
+  private:
+    template <size_t... Is>
+    void startAll(std::index_sequence<Is...>)
+    {
+        (startOne<Is>(), ...);
+    }
+    template <size_t I>
+    void startOne()
+    {
+        children_[I].emplace(runWhenChild(this, I, std::get<I>(tasks_), std::get<I>(values_), errors_[I]));
+        children_[I]->start(&state_);
+    }
+    template <size_t... Is>
+    std::tuple<WhenValue<Ts>...> takeValues(std::index_sequence<Is...>)
+    {
+        return std::tuple<WhenValue<Ts>...>(std::move(*std::get<Is>(values_))...);
+    }
+
+    std::tuple<Task<Ts>...> tasks_;
+    std::tuple<std::optional<WhenValue<Ts>>...> values_;
+    std::array<std::exception_ptr, sizeof...(Ts)> errors_;
+    std::array<std::optional<WhenChild>, sizeof...(Ts)> children_;
+    WhenState state_;
+};
+
+template <typename T>
+class WhenAllRangeAwaiter
+{
+  public:
+    explicit WhenAllRangeAwaiter(std::vector<Task<T>> tasks)
+        : tasks_(std::move(tasks)), values_(tasks_.size()), errors_(tasks_.size())
+    {
+        children_.reserve(tasks_.size());
+    }
+    WhenAllRangeAwaiter(const WhenAllRangeAwaiter &) = delete;
+    WhenAllRangeAwaiter &operator=(const WhenAllRangeAwaiter &) = delete;
+
+    bool await_ready() const noexcept { return tasks_.empty(); }
+    bool await_suspend(std::coroutine_handle<> parent)
+    {
+        state_.parent = parent;
+        state_.remaining = 1;
+        for (size_t i = 0; i < tasks_.size(); ++i)
+        {
+            children_.push_back(runWhenChild(this, i, tasks_[i], values_[i], errors_[i]));
+            children_.back().start(&state_);
+        }
+        return --state_.remaining != 0;
+    }
+    std::vector<WhenValue<T>> await_resume()
+    {
+        for (const std::exception_ptr &error : errors_)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+        std::vector<WhenValue<T>> results;
+        results.reserve(values_.size());
+        for (std::optional<WhenValue<T>> &value : values_)
+        {
+            results.push_back(std::move(*value));
+        }
+        return results;
+    }
+
+    void childDone(size_t) {}
+
+  private:
+    std::vector<Task<T>> tasks_;
+    std::vector<std::optional<WhenValue<T>>> values_;
+    std::vector<std::exception_ptr> errors_;
+    std::vector<WhenChild> children_;
+    WhenState state_;
+};
+
+template <typename... Ts>
+class WhenAnyAwaiter
+{
+  public:
+    static constexpr size_t kNoWinner = static_cast<size_t>(-1);
+
+    WhenAnyAwaiter(std::array<WhenCanceller, sizeof...(Ts)> cancellers, Task<Ts>... tasks)
+        : tasks_(std::move(tasks)...), cancellers_(cancellers)
+    {
+    }
+    WhenAnyAwaiter(const WhenAnyAwaiter &) = delete;
+    WhenAnyAwaiter &operator=(const WhenAnyAwaiter &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> parent)
+    {
+        state_.parent = parent;
+        state_.remaining = 1;
+        startAll(std::index_sequence_for<Ts...>{});
+        return --state_.remaining != 0;
+    }
+    WhenAnyResult<Ts...> await_resume()
+    {
+        if (errors_[winner_])
+        {
+            std::rethrow_exception(errors_[winner_]);
+        }
+        return WhenAnyResult<Ts...>{winner_, std::move(values_)};
+    }
+
+    void childDone(size_t index)
+    {
+        if (winner_ != kNoWinner)
+        {
+            return;
+        }
+        winner_ = index;
+        // 取消仍在运行的落败者，它们以 -ECANCELED 等结果尽快结束
+        for (size_t i = 0; i < started_; ++i)
+        {
+            if (i != index && !finished(i))
+            {
+                cancellers_[i]();
+            }
+        }
+    }
+
+  private:
+    template <size_t... Is>
+    void startAll(std::index_sequence<Is...>)
+    {
+        (startOne<Is>(), ...);
+    }
+    template <size_t I>
+    void startOne()
+    {
+        // 已经决出胜者（前面的子操作同步完成）时不再启动后续子操作
+        if (winner_ != kNoWinner)
+        {
+            return;
+        }
+        ++started_;
+        children_[I].emplace(runWhenChild(this, I, std::get<I>(tasks_), std::get<I>(values_), errors_[I]));
+        children_[I]->start(&state_);
+    }
+    bool finished(size_t index) const
+    {
+        return finishedImpl(index, std::index_sequence_for<Ts...>{});
+    }
+    template <size_t... Is>
+    bool finishedImpl(size_t index, std::index_sequence<Is...>) const
+    {
+        bool done = false;
+        ((index == Is ? (done = std::get<Is>(values_).has_value() || errors_[Is] != nullptr) : false), ...);
+        return done;
+    }
+
+    std::tuple<Task<Ts>...> tasks_;
+    std::tuple<std::optional<WhenValue<Ts>>...> values_;
+    std::array<std::exception_ptr, sizeof...(Ts)> errors_;
+    std::array<std::optional<WhenChild>, sizeof...(Ts)> children_;
+    std::array<WhenCanceller, sizeof...(Ts)> cancellers_;
+    WhenState state_;
+    size_t started_ = 0;
+    size_t winner_ = kNoWinner;
+};
+} // namespace detail
+
+// 并发等待全部子操作（Task<T> 或 Awaitable），结果为按参数顺序排列的 tuple
+template <typename... Awaitables>
+    requires(detail::WhenAwaitable<std::remove_cvref_t<Awaitables>> && ...)
+detail::WhenAllAwaiter<detail::WhenResultOf<Awaitables>...> when_all(Awaitables &&...children)
+{
+    return detail::WhenAllAwaiter<detail::WhenResultOf<Awaitables>...>(
+        detail::makeWhenTask(std::forward<Awaitables>(children))...);
+}
+
+// 并发等待一组同类型的 Task（如按候选分片扇出的特征查询），结果按下标排列
+template <typename T>
+detail::WhenAllRangeAwaiter<T> when_all(std::vector<Task<T>> tasks)
+{
+    return detail::WhenAllRangeAwaiter<T>(std::move(tasks));
+}
+
+// 等待最先完成的子操作，并通过 io_uring 异步取消其余仍在运行的子操作
+// 典型用法：co_await when_any(conn->asyncRead(4096), AsyncSleepAwaitable(loop, 200ms))
+template <typename... Awaitables>
+    requires(detail::WhenAwaitable<std::remove_cvref_t<Awaitables>> && ...)
+detail::WhenAnyAwaiter<detail::WhenResultOf<Awaitables>...> when_any(Awaitables &&...children)
+{
+    static_assert(sizeof...(Awaitables) > 0, "when_any requires at least one awaitable");
+    return detail::WhenAnyAwaiter<detail::WhenResultOf<Awaitables>...>(
+        std::array<detail::WhenCanceller, sizeof...(Awaitables)>{detail::makeWhenCanceller(children)...},
+        detail::makeWhenTask(std::forward<Awaitables>(children))...);
+}
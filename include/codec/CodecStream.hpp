@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "AsyncGenerator.hpp"
+#include "HttpCodec.hpp"
+#include "RpcCodec.hpp"
+
+class TcpConnection;
+
+/**
+ * 编解码流适配器：把"读 socket -> 解码 -> 处理"的手写循环封装为异步生成器
+ *
+ *   auto requests = httpRequests(conn);
+ *   while (HttpRequest *req = co_await requests.next())
+ *   {
+ *       ... // 处理 *req 并发送响应；缓冲区中已有的流水线请求在下一次 next() 时直接产出，不再读 socket
+ *   }
+ *
+ * - socket 数据直接读入生成器内的解码缓冲区，不经过已注册缓冲区中转拷贝；
+ * - 产出的消息对象在生成器内复用，next() 返回其指针，下一次 next() 前有效；
+ * - 对端关闭、读失败或协议错误时生成器结束（next() 返回 nullptr），连接的关闭由调用方处理；
+ * - 服务器排空（TcpServer::drain）时，在请求边界上结束生成器，读了一半的请求仍会读完并产出。
+ */
+
+// 从连接中解码 HTTP 请求流，readSize 为单次读取的字节数
+AsyncGenerator<HttpRequest> httpRequests(std::shared_ptr<TcpConnection> conn, size_t readSize = 4096);
+
+// 从连接中解码 RPC 消息流
+AsyncGenerator<RpcMessage> rpcMessages(std::shared_ptr<TcpConnection> conn, size_t readSize = 4096);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Buffer.hpp"
+#include <memory_resource>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -94,7 +95,21 @@ class HttpCodec
      * @param buf 输出缓冲区
      * @param response 待发送的响应对象
      */
-    static void encode(Buffer *buf, const HttpResponse &response);
+    static void encode(Buffer *buf, const HttpResponse &response)
+    {
+        encode(buf, response, std::pmr::get_default_resource());
+    }
+
+    /**
+     * @brief 同上，响应头的临时字符串从 mr 分配
+     *
+     * 处理器持有请求 arena 时传入它，编码过程不再单独 malloc/free。
+     *
+     * @param buf 输出缓冲区
+     * @param response 待发送的响应对象
+     * @param mr 临时字符串使用的内存资源（如 RequestArena）
+     */
+    static void encode(Buffer *buf, const HttpResponse &response, std::pmr::memory_resource *mr);
 
   private:
     // 内部解析辅助函数
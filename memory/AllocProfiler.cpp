@@ -0,0 +1,227 @@
+#include "AllocProfiler.hpp"
+
+#include <execinfo.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+std::atomic<bool> AllocProfiler::enabled_{false};
+std::atomic<size_t> AllocProfiler::sampleInterval_{0};
+std::atomic<uint64_t> AllocProfiler::totalSamples_{0};
+std::array<AllocProfiler::ClassCounters, ALLOC_PROFILE_CLASS_NUM>
+    AllocProfiler::counters_;
+std::array<std::atomic<uint32_t>, ALLOC_PROFILE_FILTER_SIZE>
+    AllocProfiler::filter_{};
+
+namespace {
+constexpr size_t kShardNum = 64;
+
+struct SampleRecord {
+  size_t size;
+  std::chrono::steady_clock::time_point time;
+  int depth;
+  void* frames[ALLOC_PROFILE_MAX_FRAMES];
+};
+
+// 存活的采样记录，按指针分片加锁
+struct alignas(64) SampleShard {
+  std::mutex mutex;
+  std::unordered_map<void*, SampleRecord> records;
+};
+
+std::array<SampleShard, kShardNum> g_shards;
+
+// 每个线程距离下一次采样还剩的分配次数
+thread_local size_t t_countdown = 0;
+
+size_t pointerHash(void* p) {
+  // 槽至少 8 字节对齐，低位没有信息；乘法哈希把高位打散到低位
+  return static_cast<size_t>((reinterpret_cast<uintptr_t>(p) >> 3) *
+                             0x9E3779B97F4A7C15ull >> 32);
+}
+
+SampleShard& shardOf(void* p) { return g_shards[pointerHash(p) % kShardNum]; }
+}  // namespace
+
+void AllocProfiler::enable(size_t sampleInterval) {
+  sampleInterval_.store(sampleInterval, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+}
+
+void AllocProfiler::disable() {
+  enabled_.store(false, std::memory_order_release);
+  // 关闭后释放不再删除记录，保留下来的记录会变成假的"存活"采样，直接丢弃
+  for (SampleShard& shard : g_shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.records.clear();
+  }
+  for (std::atomic<uint32_t>& count : filter_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t AllocProfiler::filterIndex(void* p) noexcept {
+  return pointerHash(p) / kShardNum % ALLOC_PROFILE_FILTER_SIZE;
+}
+
+void AllocProfiler::recordAllocation(void* p, size_t size, size_t index) {
+  ClassCounters& counters = counters_[index];
+  uint64_t allocations =
+      counters.allocations.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (index == MEMORY_POOL_NUM) {
+    counters.liveBytes.fetch_add(static_cast<int64_t>(size),
+                                 std::memory_order_relaxed);
+  }
+  // 峰值只在创新高时才写，平稳状态下只是一次读
+  int64_t live = static_cast<int64_t>(
+      allocations - counters.deallocations.load(std::memory_order_relaxed));
+  int64_t high = counters.highWater.load(std::memory_order_relaxed);
+  while (live > high && !counters.highWater.compare_exchange_weak(
+                            high, live, std::memory_order_relaxed)) {
+  }
+
+  size_t interval = sampleInterval_.load(std::memory_order_relaxed);
+  if (interval == 0) {
+    return;
+  }
+  if (t_countdown == 0 || t_countdown > interval) {
+    t_countdown = interval;
+  }
+  if (--t_countdown == 0) {
+    sample(p, size);
+  }
+}
+
+void AllocProfiler::recordDeallocation(void* p, size_t size, size_t index) {
+  ClassCounters& counters = counters_[index];
+  counters.deallocations.fetch_add(1, std::memory_order_relaxed);
+  if (index == MEMORY_POOL_NUM) {
+    counters.liveBytes.fetch_sub(static_cast<int64_t>(size),
+                                 std::memory_order_relaxed);
+  }
+  // 槽被重新分配之前必须删除记录，否则新分配会被误认为旧调用点持有
+  if (filter_[filterIndex(p)].load(std::memory_order_acquire) != 0) {
+    forget(p);
+  }
+}
+
+// 不内联：保证第一帧总是 sample 自身
+[[gnu::noinline]] void AllocProfiler::sample(void* p, size_t size) {
+  SampleRecord record;
+  record.size = size;
+  record.time = std::chrono::steady_clock::now();
+  void* frames[ALLOC_PROFILE_MAX_FRAMES + 1];
+  int depth = ::backtrace(frames, ALLOC_PROFILE_MAX_FRAMES + 1);
+  // 只跳过 sample 自身：recordAllocation 可能被优化为尾调用而没有栈帧，固定跳过更多会误删调用方
+  int skip = std::min(depth, 1);
+  record.depth = depth - skip;
+  std::memcpy(record.frames, frames + skip, record.depth * sizeof(void*));
+
+  SampleShard& shard = shardOf(p);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.records.insert_or_assign(p, record).second) {
+      // 同一地址的旧记录未被删除（如开启前分配的槽），覆盖即可，计数表不重复累加
+      totalSamples_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+  filter_[filterIndex(p)].fetch_add(1, std::memory_order_release);
+  totalSamples_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocProfiler::forget(void* p) {
+  SampleShard& shard = shardOf(p);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.records.erase(p) > 0) {
+    filter_[filterIndex(p)].fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+AllocProfiler::Report AllocProfiler::report(size_t maxSites) {
+  Report report;
+  report.enabled = enabled();
+  report.sampleInterval = sampleInterval_.load(std::memory_order_relaxed);
+  report.totalSamples = totalSamples_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < ALLOC_PROFILE_CLASS_NUM; ++i) {
+    const ClassCounters& counters = counters_[i];
+    ClassStats& stats = report.classes[i];
+    stats.slotSize = i < MEMORY_POOL_NUM ? (i + 1) * SLOT_BASE_SIZE : 0;
+    // 先读释放再读分配，并发下 live 只会偏大而不会出现瞬时负数
+    stats.deallocations = counters.deallocations.load(std::memory_order_relaxed);
+    stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+    stats.live = static_cast<int64_t>(stats.allocations - stats.deallocations);
+    stats.highWater = counters.highWater.load(std::memory_order_relaxed);
+    stats.liveBytes =
+        i < MEMORY_POOL_NUM
+            ? stats.live * static_cast<int64_t>(stats.slotSize)
+            : counters.liveBytes.load(std::memory_order_relaxed);
+  }
+
+  // 按调用栈聚合存活采样：先在锁内复制出栈地址，符号化放到锁外
+  struct Aggregate {
+    size_t samples = 0;
+    size_t bytes = 0;
+    std::chrono::steady_clock::time_point oldest =
+        std::chrono::steady_clock::time_point::max();
+    int depth = 0;
+    void* frames[ALLOC_PROFILE_MAX_FRAMES];
+  };
+  std::map<std::vector<void*>, Aggregate> aggregates;
+  for (SampleShard& shard : g_shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    report.liveSamples += shard.records.size();
+    for (const auto& [p, record] : shard.records) {
+      std::vector<void*> key(record.frames, record.frames + record.depth);
+      Aggregate& agg = aggregates[key];
+      ++agg.samples;
+      agg.bytes += record.size;
+      agg.oldest = std::min(agg.oldest, record.time);
+      agg.depth = record.depth;
+      std::memcpy(agg.frames, record.frames, record.depth * sizeof(void*));
+    }
+  }
+
+  std::vector<const Aggregate*> sorted;
+  sorted.reserve(aggregates.size());
+  for (const auto& [key, agg] : aggregates) {
+    sorted.push_back(&agg);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const Aggregate* a, const Aggregate* b) {
+              return a->bytes > b->bytes;
+            });
+  if (sorted.size() > maxSites) {
+    sorted.resize(maxSites);
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  for (const Aggregate* agg : sorted) {
+    Site site;
+    site.samples = agg->samples;
+    site.sampledBytes = agg->bytes;
+    site.estimatedBytes = agg->bytes * std::max<size_t>(report.sampleInterval, 1);
+    site.oldestAge =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - agg->oldest);
+    char** symbols = ::backtrace_symbols(agg->frames, agg->depth);
+    for (int i = 0; i < agg->depth; ++i) {
+      site.frames.emplace_back(symbols ? symbols[i] : "?");
+    }
+    std::free(symbols);
+    report.sites.push_back(std::move(site));
+  }
+  return report;
+}
+
+void AllocProfiler::resetHighWater() {
+  for (ClassCounters& counters : counters_) {
+    int64_t live = static_cast<int64_t>(
+        counters.allocations.load(std::memory_order_relaxed) -
+        counters.deallocations.load(std::memory_order_relaxed));
+    counters.highWater.store(live, std::memory_order_relaxed);
+  }
+}
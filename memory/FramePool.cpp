@@ -0,0 +1,109 @@
+#include "FramePool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+thread_local FramePool* FramePool::current_ = nullptr;
+
+FramePool::~FramePool() {
+  detachFromCurrentThread();
+  // 归还所有缓存的空闲帧
+  for (FreeFrame*& head : freeLists_) {
+    while (head) {
+      FreeFrame* next = head->next;
+      std::free(head);
+      head = next;
+    }
+  }
+}
+
+void FramePool::attachToCurrentThread() { current_ = this; }
+
+void FramePool::detachFromCurrentThread() {
+  if (current_ == this) {
+    current_ = nullptr;
+  }
+}
+
+void* FramePool::allocate(size_t size) {
+  FramePool* pool = current_;
+  if (pool) {
+    return pool->allocateFrame(size);
+  }
+  // 当前线程没有帧池：按类别大小分配，保证之后在有帧池的线程释放时能放进对应的空闲链表
+  void* p = std::malloc(size <= MAX_POOLED_FRAME_SIZE ? classBytes(sizeClassOf(size)) : size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void FramePool::deallocate(void* p, size_t size) {
+  if (!p) {
+    return;
+  }
+  FramePool* pool = current_;
+  if (pool) {
+    pool->deallocateFrame(p, size);
+    return;
+  }
+  std::free(p);
+}
+
+void* FramePool::allocateFrame(size_t size) {
+  ++stats_.allocations;
+  if (size == 0 || size > MAX_POOLED_FRAME_SIZE) {
+    ++stats_.largeAllocations;
+    ++stats_.sizeHistogram[FRAME_SIZE_CLASS_NUM];
+    void* p = std::malloc(size);
+    if (!p) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  size_t cls = sizeClassOf(size);
+  ++stats_.sizeHistogram[cls];
+  liveBytes_ += classBytes(cls);
+  stats_.peakLiveBytes = std::max(stats_.peakLiveBytes, liveBytes_);
+
+  FreeFrame* frame = freeLists_[cls];
+  if (frame) {
+    // 命中空闲链表：单线程访问，无需加锁
+    freeLists_[cls] = frame->next;
+    --freeCounts_[cls];
+    stats_.cachedBytes -= classBytes(cls);
+    ++stats_.cacheHits;
+    return frame;
+  }
+
+  // 按类别的上限大小分配，释放后才能被同类别的任意帧复用
+  void* p = std::malloc(classBytes(cls));
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void FramePool::deallocateFrame(void* p, size_t size) {
+  ++stats_.deallocations;
+  if (size == 0 || size > MAX_POOLED_FRAME_SIZE) {
+    std::free(p);
+    return;
+  }
+
+  size_t cls = sizeClassOf(size);
+  size_t bytes = classBytes(cls);
+  liveBytes_ = liveBytes_ >= bytes ? liveBytes_ - bytes : 0;
+  if (freeCounts_[cls] >= FRAME_CACHE_LIMIT) {
+    // 缓存已满（如连接数骤降），多余的帧还给系统，避免长期占用内存
+    std::free(p);
+    return;
+  }
+  FreeFrame* frame = static_cast<FreeFrame*>(p);
+  frame->next = freeLists_[cls];
+  freeLists_[cls] = frame;
+  ++freeCounts_[cls];
+  stats_.cachedBytes += bytes;
+}
@@ -1,105 +1,496 @@
 #include "MemoryPool.hpp"
 
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <unordered_map>
+
+#include "AllocProfiler.hpp"
+
 // 静态成员定义
 MemoryPool HashBucket::memoryPool[MEMORY_POOL_NUM];
+HashBucket::Options HashBucket::options_;
+
+namespace {
+// 线程缓存析构后置位：线程退出阶段其他 thread_local 对象的析构中仍可能释放内存，此时直接走全局内存池
+thread_local bool t_threadCacheDestroyed = false;
+}  // namespace
 
 MemoryPool::MemoryPool(size_t blockSize)
-    : blockSize_(blockSize),
+    : blockSize_(std::bit_ceil(blockSize)),
       slotSize_(0),
       firstBlock_(nullptr),
-      curSlot_(nullptr),
-      freeList_(nullptr),
-      lastSlot_(nullptr) {}
+      curBlock_(nullptr),
+      freeList_(0) {}
 
 MemoryPool::~MemoryPool() {
-  // 释放所有内存块
-  Slot* cur = firstBlock_;
-  while (cur) {
-    Slot* next = cur->next;  // 保存下一个内存块指针
-    ::free(reinterpret_cast<void*>(
-        cur));  // 这里将slot*转为void*，保证申请释放对称性，且明确MemoryPool只管理内存分配与释放，不涉及对象构造和析构，析构对象应该由调用者使用deleteElement来完成
-    cur = next;
+  // 释放所有内存块（包括已归还物理内存、只保留地址空间的内存块）
+  for (BlockHeader* list : {firstBlock_, purgedBlocks_}) {
+    BlockHeader* cur = list;
+    while (cur) {
+      BlockHeader* next = cur->next;  // 保存下一个内存块指针
+      cur->~BlockHeader();
+      // 只归还映射，MemoryPool只管理内存分配与释放，不涉及对象构造和析构，析构对象应该由调用者使用deleteElement来完成
+      ::munmap(cur, blockSize_);
+      cur = next;
+    }
   }
 }
 
-void MemoryPool::init(size_t slotSize) { slotSize_ = slotSize; }
+void MemoryPool::init(size_t slotSize, size_t blockSize, bool hugePages) {
+  slotSize_ = slotSize;
+  if (blockSize > 0) {
+    // 按块大小对齐后才能由槽地址找到所属内存块
+    blockSize_ = std::bit_ceil(
+        std::max(blockSize, static_cast<size_t>(::sysconf(_SC_PAGESIZE))));
+  }
+  hugePages_ = hugePages;
+}
 
 void* MemoryPool::allocate() {
   // 优先使用空闲链表中的内存槽
-  if (freeList_) {
-    std::lock_guard<std::mutex> lock(mutexForFreeList_);
-    if (freeList_) {
-      Slot* slot = freeList_;
-      freeList_ = freeList_->next;
-      return reinterpret_cast<void*>(slot);
-    }
+  if (Slot* slot = popFree()) {
+    freeSlots_.fetch_sub(1, std::memory_order_relaxed);
+    return slot;
   }
   // 如果空闲链表为空，使用当前内存块中尚未使用的内存槽
-  Slot* temp = nullptr;
-  {
-    std::lock_guard<std::mutex> lock(mutexForBlock_);
-    if (curSlot_ > lastSlot_) {
-      // 说明此时该内存块中也没有可用的内存槽，需要申请新的内存块
-      // 申请新内存块后，curSlot_与lastSlot_会更新为指向新内存块
-      allocateNewBlock();
-    }
-    temp = curSlot_;
-    curSlot_ += slotSize_ / sizeof(Slot);
-  }
-  return temp;
+  Slot* slot = nullptr;
+  carve(slot, 1);
+  return slot;
 }
 
 void MemoryPool::deallocate(void* p) {
   // 头插法
   if (p) {
-    std::lock_guard<std::mutex> lock(mutexForFreeList_);
     Slot* slot = reinterpret_cast<Slot*>(p);
-    slot->next = freeList_;
-    freeList_ = slot;
+    pushFree(slot, slot);
+    freeSlots_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+size_t MemoryPool::allocateBatch(Slot*& head, size_t n) {
+  Slot* chain = nullptr;
+  size_t got = 0;
+  // 先从空闲链表逐个弹出，每个槽一次 CAS
+  while (got < n) {
+    Slot* slot = popFree();
+    if (!slot) {
+      break;
+    }
+    slot->next = chain;
+    chain = slot;
+    ++got;
+  }
+  if (got > 0) {
+    freeSlots_.fetch_sub(got, std::memory_order_relaxed);
+  }
+  // 不够的部分从内存块中切，一次 fetch_add 切出一批
+  if (got < n) {
+    got += carve(chain, n - got);
+  }
+  head = chain;
+  return got;
+}
+
+void MemoryPool::deallocateBatch(Slot* head, Slot* tail, size_t n) {
+  if (!head || n == 0) {
+    return;
+  }
+  // 整条链表一次 CAS 接到空闲链表头部
+  pushFree(head, tail);
+  freeSlots_.fetch_add(n, std::memory_order_relaxed);
+}
+
+Slot* MemoryPool::popFree() {
+  uint64_t old = freeList_.load(std::memory_order_acquire);
+  while (true) {
+    Slot* head = ptrOf(old);
+    if (!head) {
+      return nullptr;
+    }
+    // head 可能已被其他线程弹出并写入用户数据，读到的 next 是脏值；此时链表头的标签必然已经变化，
+    // 下面的 CAS 会失败重试。内存块从不归还给 OS，读取本身总是安全的
+    Slot* next = std::atomic_ref<Slot*>(head->next).load(std::memory_order_relaxed);
+    if (freeList_.compare_exchange_weak(
+            old, reinterpret_cast<uint64_t>(next) | nextTag(old),
+            std::memory_order_acquire, std::memory_order_acquire)) {
+      return head;
+    }
   }
 }
 
-void MemoryPool::allocateNewBlock() {
-  void* newBlock = ::malloc(blockSize_);
-  if (newBlock) {
-    // 使用头插法将新内存块插入内存块链表
-    reinterpret_cast<Slot*>(newBlock)->next = firstBlock_;
-    firstBlock_ = reinterpret_cast<Slot*>(newBlock);
-    curSlot_ = firstBlock_;
+void MemoryPool::pushFree(Slot* head, Slot* tail) {
+  uint64_t old = freeList_.load(std::memory_order_relaxed);
+  uint64_t desired;
+  do {
+    std::atomic_ref<Slot*>(tail->next).store(ptrOf(old),
+                                             std::memory_order_relaxed);
+    desired = reinterpret_cast<uint64_t>(head) | nextTag(old);
+  } while (!freeList_.compare_exchange_weak(old, desired,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed));
+}
+
+Slot* MemoryPool::takeAllFree() {
+  uint64_t old = freeList_.load(std::memory_order_acquire);
+  // 换成空链表时同样递增标签，正在弹出旧链表头的线程 CAS 必然失败
+  while (!freeList_.compare_exchange_weak(old, nextTag(old),
+                                          std::memory_order_acquire,
+                                          std::memory_order_acquire)) {
   }
-  char* endofhead = reinterpret_cast<char*>(newBlock) + sizeof(Slot*);
+  return ptrOf(old);
+}
+
+size_t MemoryPool::carve(Slot*& chain, size_t n) {
+  size_t got = 0;
+  while (got < n) {
+    BlockHeader* block = curBlock_.load(std::memory_order_acquire);
+    if (block) {
+      size_t want = n - got;
+      uintptr_t begin = block->cur.fetch_add(want * slotSize_,
+                                             std::memory_order_relaxed);
+      // 越过 end 的部分作废：块尾不足一个槽的空间以及并发切分越界的部分都不再使用
+      size_t avail = begin < block->end ? (block->end - begin) / slotSize_ : 0;
+      size_t take = std::min(want, avail);
+      for (size_t i = 0; i < take; ++i) {
+        Slot* slot = reinterpret_cast<Slot*>(begin + i * slotSize_);
+        slot->next = chain;
+        chain = slot;
+      }
+      got += take;
+      carvedSlots_.fetch_add(take, std::memory_order_relaxed);
+      if (take == want) {
+        break;
+      }
+    }
+    // 当前块已耗尽（或尚未申请过内存块），需要申请新的内存块
+    if (!allocateNewBlock(block)) {
+      break;
+    }
+  }
+  return got;
+}
+
+bool MemoryPool::allocateNewBlock(BlockHeader* exhausted) {
+  std::lock_guard<std::mutex> lock(mutexForBlock_);
+  if (curBlock_.load(std::memory_order_relaxed) != exhausted) {
+    // 其他线程已经换上了新块
+    return true;
+  }
+  // 优先复用已归还物理内存的内存块（头部所在页未归还，头部仍然有效），重新访问时由缺页补回
+  BlockHeader* header = nullptr;
+  if (purgedBlocks_) {
+    header = purgedBlocks_;
+    purgedBlocks_ = header->next;
+    purgedCount_.fetch_sub(1, std::memory_order_relaxed);
+  } else {
+    void* newBlock = mapBlock();
+    if (!newBlock) {
+      return false;
+    }
+    // 空闲链表头只有 48 位存放地址
+    assert((reinterpret_cast<uint64_t>(newBlock) & ~kPtrMask) == 0);
+    header = new (newBlock) BlockHeader{};
+  }
+
+  // 使用头插法将新内存块插入内存块链表
+  header->next = firstBlock_;
+  firstBlock_ = header;
+  blockCount_.fetch_add(1, std::memory_order_relaxed);
+
+  char* endofhead = reinterpret_cast<char*>(header) + sizeof(BlockHeader);
   size_t paddingsize = padPointer(endofhead, slotSize_);
-  curSlot_ = reinterpret_cast<Slot*>(endofhead + paddingsize);
+  uintptr_t first = reinterpret_cast<uintptr_t>(endofhead + paddingsize);
+  header->end = reinterpret_cast<uintptr_t>(header) + blockSize_;
+  header->capacity = (header->end - first) / slotSize_;
+  header->cur.store(first, std::memory_order_relaxed);
 
-  lastSlot_ = reinterpret_cast<Slot*>(reinterpret_cast<size_t>(newBlock) +
-                                      blockSize_ - slotSize_ + 1);
-  freeList_ = nullptr;  // 新内存块没有空闲槽，清空 freeList_
+  curBlock_.store(header, std::memory_order_release);
+  return true;
+}
+
+void* MemoryPool::mapBlock() {
+  // 多映射一个块大小再裁掉首尾，得到按块大小对齐的地址
+  size_t length = blockSize_ * 2;
+  void* raw = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    return nullptr;
+  }
+  uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+  uintptr_t aligned = (begin + blockSize_ - 1) & ~(blockSize_ - 1);
+  if (aligned > begin) {
+    ::munmap(raw, aligned - begin);
+  }
+  uintptr_t tail = aligned + blockSize_;
+  if (begin + length > tail) {
+    ::munmap(reinterpret_cast<void*>(tail), begin + length - tail);
+  }
+  if (hugePages_) {
+    ::madvise(reinterpret_cast<void*>(aligned), blockSize_, MADV_HUGEPAGE);
+  }
+  return reinterpret_cast<void*>(aligned);
+}
+
+size_t MemoryPool::release(size_t retainBlocks) {
+  std::lock_guard<std::mutex> lock(mutexForBlock_);
+  BlockHeader* current = curBlock_.load(std::memory_order_acquire);
+
+  // 摘下整个空闲链表，按所属内存块统计空闲槽数；期间其他线程的释放进入新的空链表，只会让统计偏少（不会误判为全空）
+  Slot* chain = takeAllFree();
+  std::unordered_map<BlockHeader*, size_t> freeCounts;
+  for (Slot* slot = chain; slot; slot = slot->next) {
+    ++freeCounts[reinterpret_cast<BlockHeader*>(
+        reinterpret_cast<uintptr_t>(slot) & ~(blockSize_ - 1))];
+  }
+
+  // 非当前块都已切分完毕，空闲槽数等于容量即全部空闲；正在切分的当前块不归还
+  std::unordered_map<BlockHeader*, bool> releasable;
+  size_t retained = 0;
+  for (const auto& [block, count] : freeCounts) {
+    if (block != current && count == block->capacity) {
+      if (retained < retainBlocks) {
+        ++retained;
+        continue;
+      }
+      releasable[block] = true;
+    }
+  }
+
+  // 其余槽放回空闲链表
+  Slot* keepHead = nullptr;
+  Slot* keepTail = nullptr;
+  size_t dropped = 0;
+  for (Slot* slot = chain; slot;) {
+    Slot* next = slot->next;
+    BlockHeader* block = reinterpret_cast<BlockHeader*>(
+        reinterpret_cast<uintptr_t>(slot) & ~(blockSize_ - 1));
+    if (releasable.count(block)) {
+      ++dropped;
+    } else {
+      slot->next = keepHead;
+      keepHead = slot;
+      if (!keepTail) {
+        keepTail = slot;
+      }
+    }
+    slot = next;
+  }
+  if (keepHead) {
+    pushFree(keepHead, keepTail);
+  }
+  freeSlots_.fetch_sub(dropped, std::memory_order_relaxed);
+  carvedSlots_.fetch_sub(dropped, std::memory_order_relaxed);
+  if (releasable.empty()) {
+    return 0;
+  }
+
+  // 从内存块链表中摘除，归还除头部所在页之外的物理内存
+  size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  size_t released = 0;
+  BlockHeader** link = &firstBlock_;
+  while (*link) {
+    BlockHeader* block = *link;
+    if (!releasable.count(block)) {
+      link = &block->next;
+      continue;
+    }
+    *link = block->next;
+    ::madvise(reinterpret_cast<char*>(block) + pageSize,
+              blockSize_ - pageSize, MADV_DONTNEED);
+    block->next = purgedBlocks_;
+    purgedBlocks_ = block;
+    released += blockSize_ - pageSize;
+  }
+  blockCount_.fetch_sub(releasable.size(), std::memory_order_relaxed);
+  purgedCount_.fetch_add(releasable.size(), std::memory_order_relaxed);
+  releasedBytes_.fetch_add(released, std::memory_order_relaxed);
+  return released;
+}
+
+double MemoryPool::freeRatio() const {
+  size_t carved = carvedSlots_.load(std::memory_order_relaxed);
+  if (carved == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(freeSlots_.load(std::memory_order_relaxed)) /
+         static_cast<double>(carved);
+}
+
+MemoryPool::Stats MemoryPool::getStats() const {
+  Stats stats;
+  stats.slotSize = slotSize_;
+  stats.blockSize = blockSize_;
+  stats.blocks = blockCount_.load(std::memory_order_relaxed);
+  stats.purgedBlocks = purgedCount_.load(std::memory_order_relaxed);
+  stats.freeSlots = freeSlots_.load(std::memory_order_relaxed);
+  size_t carved = carvedSlots_.load(std::memory_order_relaxed);
+  stats.liveSlots = carved > stats.freeSlots ? carved - stats.freeSlots : 0;
+  stats.releasedBytes = releasedBytes_.load(std::memory_order_relaxed);
+  size_t capacityBytes = stats.blocks * blockSize_;
+  if (capacityBytes > 0) {
+    stats.fragmentation =
+        1.0 - static_cast<double>(stats.liveSlots * slotSize_) /
+                  static_cast<double>(capacityBytes);
+  }
+  return stats;
 }
 
 size_t MemoryPool::padPointer(char* p, size_t slotSize) {
   return (slotSize - reinterpret_cast<size_t>(p)) % slotSize;
 }
 
-void HashBucket::initMemoryPool() {
-  for (int i = 1; i < MEMORY_POOL_NUM; ++i) {
-    getMemoryPool(i).init((i + 1) * SLOT_BASE_SIZE);
+ThreadCache::~ThreadCache() {
+  flushAll();
+  t_threadCacheDestroyed = true;
+}
+
+size_t ThreadCache::capacityOf(size_t index) {
+  size_t slotSize = (index + 1) * SLOT_BASE_SIZE;
+  return std::clamp(THREAD_CACHE_BYTES_PER_CLASS / slotSize,
+                    THREAD_CACHE_MIN_SLOTS, THREAD_CACHE_MAX_SLOTS);
+}
+
+void* ThreadCache::allocate(size_t index) {
+  FreeList& list = lists_[index];
+  if (!list.head) {
+    refill(index);
+    if (!list.head) {
+      return nullptr;
+    }
+  }
+  Slot* slot = list.head;
+  list.head = slot->next;
+  --list.count;
+  return slot;
+}
+
+void ThreadCache::deallocate(void* p, size_t index) {
+  FreeList& list = lists_[index];
+  size_t capacity = capacityOf(index);
+  if (list.count >= capacity) {
+    flush(index, capacity / 2);
+  }
+  Slot* slot = static_cast<Slot*>(p);
+  slot->next = list.head;
+  list.head = slot;
+  ++list.count;
+}
+
+void ThreadCache::flushAll() {
+  for (size_t i = 0; i < MEMORY_POOL_NUM; ++i) {
+    flush(i, lists_[i].count);
+  }
+}
+
+void ThreadCache::refill(size_t index) {
+  FreeList& list = lists_[index];
+  Slot* head = nullptr;
+  size_t got = HashBucket::getMemoryPool(static_cast<int>(index))
+                   .allocateBatch(head, capacityOf(index) / 2);
+  // 只在链表为空时调用，直接接管取出的链表
+  list.head = head;
+  list.count = got;
+}
+
+void ThreadCache::flush(size_t index, size_t n) {
+  FreeList& list = lists_[index];
+  n = std::min(n, list.count);
+  if (n == 0) {
+    return;
+  }
+  Slot* head = list.head;
+  Slot* tail = head;
+  for (size_t i = 1; i < n; ++i) {
+    tail = tail->next;
+  }
+  list.head = tail->next;
+  list.count -= n;
+  HashBucket::getMemoryPool(static_cast<int>(index))
+      .deallocateBatch(head, tail, n);
+}
+
+void HashBucket::initMemoryPool() { initMemoryPool(Options()); }
+
+void HashBucket::initMemoryPool(const Options& options) {
+  options_ = options;
+  // 从 0 开始：8 字节类别同样需要初始化槽大小
+  for (size_t i = 0; i < MEMORY_POOL_NUM; ++i) {
+    size_t slotSize = (i + 1) * SLOT_BASE_SIZE;
+    // 每个类别按槽大小选择块大小：小对象不浪费，大对象每块也能容纳足够多的槽
+    size_t blockSize = std::clamp(std::bit_ceil(slotSize * options.slotsPerBlock),
+                                  options.minBlockSize, options.maxBlockSize);
+    getMemoryPool(i).init(slotSize, blockSize, options.hugePages);
+  }
+  if (options.profiling) {
+    AllocProfiler::enable(options.profileSampleInterval);
+  }
+}
+
+size_t HashBucket::trim() {
+  size_t released = 0;
+  for (size_t i = 0; i < MEMORY_POOL_NUM; ++i) {
+    MemoryPool& pool = getMemoryPool(i);
+    if (pool.freeRatio() >= options_.trimFreeRatio) {
+      released += pool.release(options_.retainFreeBlocks);
+    }
+  }
+  return released;
+}
+
+std::array<MemoryPool::Stats, MEMORY_POOL_NUM> HashBucket::getStats() {
+  std::array<MemoryPool::Stats, MEMORY_POOL_NUM> stats;
+  for (size_t i = 0; i < MEMORY_POOL_NUM; ++i) {
+    stats[i] = getMemoryPool(i).getStats();
   }
+  return stats;
 }
 
 MemoryPool& HashBucket::getMemoryPool(int index) { return memoryPool[index]; }
 
+ThreadCache* HashBucket::threadCache() {
+  if (t_threadCacheDestroyed) {
+    return nullptr;
+  }
+  thread_local ThreadCache cache;
+  return &cache;
+}
+
+void HashBucket::flushThreadCache() {
+  if (ThreadCache* cache = threadCache()) {
+    cache->flushAll();
+  }
+}
+
 void* HashBucket::useMemory(size_t size) {
   if (size <= 0) return nullptr;
 
   // 若大于512字节，直接使用系统分配
   if (size > MAX_SLOT_SIZE) {
-    return ::malloc(size);
+    void* p = ::malloc(size);
+    if (p && AllocProfiler::enabled()) {
+      AllocProfiler::recordAllocation(p, size, MEMORY_POOL_NUM);
+    }
+    return p;
   }
 
   // 否则从内存池分配
   // 计算该size应该使用的内存池索引
   int index = (size + 7) / SLOT_BASE_SIZE - 1;
-  return getMemoryPool(index).allocate();
+  // 优先走本线程缓存，不加锁
+  void* p;
+  if (ThreadCache* cache = threadCache()) {
+    p = cache->allocate(static_cast<size_t>(index));
+  } else {
+    p = getMemoryPool(index).allocate();
+  }
+  if (p && AllocProfiler::enabled()) {
+    AllocProfiler::recordAllocation(p, size, static_cast<size_t>(index));
+  }
+  return p;
 }
 
 void HashBucket::freeMemory(void* p, size_t size) {
@@ -107,11 +498,22 @@ void HashBucket::freeMemory(void* p, size_t size) {
 
   // 大于512字节，释放给系统
   if (size > MAX_SLOT_SIZE) {
+    if (AllocProfiler::enabled()) {
+      AllocProfiler::recordDeallocation(p, size, MEMORY_POOL_NUM);
+    }
     ::free(p);
     return;
   }
 
   int index = (size + 7) / SLOT_BASE_SIZE - 1;
+  // 先于归还记录：槽一旦回到缓存就可能被其他分配复用
+  if (AllocProfiler::enabled()) {
+    AllocProfiler::recordDeallocation(p, size, static_cast<size_t>(index));
+  }
+  if (ThreadCache* cache = threadCache()) {
+    cache->deallocate(p, static_cast<size_t>(index));
+    return;
+  }
   getMemoryPool(index).deallocate(p);
   return;
 }
@@ -0,0 +1,162 @@
+#include "RequestArena.hpp"
+
+#include <cstdlib>
+#include <new>
+
+thread_local ArenaChunkPool* ArenaChunkPool::current_ = nullptr;
+
+ArenaChunkPool::~ArenaChunkPool() {
+  detachFromCurrentThread();
+  while (freeList_) {
+    FreeChunk* next = freeList_->next;
+    std::free(freeList_);
+    freeList_ = next;
+  }
+}
+
+void ArenaChunkPool::attachToCurrentThread() { current_ = this; }
+
+void ArenaChunkPool::detachFromCurrentThread() {
+  if (current_ == this) {
+    current_ = nullptr;
+  }
+}
+
+void* ArenaChunkPool::acquire() {
+  ArenaChunkPool* pool = current_;
+  if (pool) {
+    return pool->acquireChunk();
+  }
+  void* p = std::malloc(ARENA_CHUNK_SIZE);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void ArenaChunkPool::release(void* chunk) {
+  ArenaChunkPool* pool = current_;
+  if (pool) {
+    pool->releaseChunk(chunk);
+    return;
+  }
+  std::free(chunk);
+}
+
+void* ArenaChunkPool::acquireChunk() {
+  ++stats_.acquired;
+  FreeChunk* chunk = freeList_;
+  if (chunk) {
+    freeList_ = chunk->next;
+    --stats_.cachedChunks;
+    ++stats_.cacheHits;
+    return chunk;
+  }
+  void* p = std::malloc(ARENA_CHUNK_SIZE);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void ArenaChunkPool::releaseChunk(void* chunk) {
+  ++stats_.released;
+  if (stats_.cachedChunks >= ARENA_CHUNK_CACHE_LIMIT) {
+    // 缓存已满（如请求量骤降），多余的块还给系统
+    std::free(chunk);
+    return;
+  }
+  FreeChunk* free = static_cast<FreeChunk*>(chunk);
+  free->next = freeList_;
+  freeList_ = free;
+  ++stats_.cachedChunks;
+}
+
+namespace {
+char* alignUp(char* p, size_t alignment) {
+  uintptr_t v = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<char*>((v + alignment - 1) & ~(uintptr_t(alignment) - 1));
+}
+}  // namespace
+
+RequestArena::RequestArena() {
+  first_ = static_cast<ChunkHeader*>(ArenaChunkPool::acquire());
+  first_->size = ARENA_CHUNK_SIZE;
+  first_->next = nullptr;
+  pushChunk(first_);
+}
+
+RequestArena::~RequestArena() {
+  while (chunks_) {
+    ChunkHeader* next = chunks_->next;
+    releaseChunk(chunks_);
+    chunks_ = next;
+  }
+}
+
+void RequestArena::reset() {
+  while (chunks_) {
+    ChunkHeader* next = chunks_->next;
+    if (chunks_ != first_) {
+      releaseChunk(chunks_);
+    }
+    chunks_ = next;
+  }
+  chunkCount_ = 0;
+  bytesAllocated_ = 0;
+  first_->next = nullptr;
+  pushChunk(first_);
+}
+
+void* RequestArena::do_allocate(size_t bytes, size_t alignment) {
+  char* p = alignUp(cur_, alignment);
+  if (p <= end_ && bytes <= static_cast<size_t>(end_ - p)) {
+    // 快路径：当前块内指针递增
+    cur_ = p + bytes;
+    bytesAllocated_ += bytes;
+    return p;
+  }
+  return allocateSlow(bytes, alignment);
+}
+
+void* RequestArena::allocateSlow(size_t bytes, size_t alignment) {
+  size_t usable = ARENA_CHUNK_SIZE - sizeof(ChunkHeader);
+  if (bytes + alignment > usable / 4) {
+    // 大请求（超过块容量的 1/4）单独分配，挂在链表上但不切换当前块，避免浪费当前块的剩余空间
+    size_t size = sizeof(ChunkHeader) + bytes + alignment;
+    ChunkHeader* chunk = static_cast<ChunkHeader*>(std::malloc(size));
+    if (!chunk) {
+      throw std::bad_alloc();
+    }
+    chunk->size = size;
+    chunk->next = chunks_->next;
+    chunks_->next = chunk;
+    ++chunkCount_;
+    bytesAllocated_ += bytes;
+    return alignUp(reinterpret_cast<char*>(chunk + 1), alignment);
+  }
+
+  ChunkHeader* chunk = static_cast<ChunkHeader*>(ArenaChunkPool::acquire());
+  chunk->size = ARENA_CHUNK_SIZE;
+  chunk->next = chunks_;
+  pushChunk(chunk);
+  char* p = alignUp(cur_, alignment);
+  cur_ = p + bytes;
+  bytesAllocated_ += bytes;
+  return p;
+}
+
+void RequestArena::pushChunk(ChunkHeader* chunk) {
+  chunks_ = chunk;
+  cur_ = reinterpret_cast<char*>(chunk + 1);
+  end_ = reinterpret_cast<char*>(chunk) + ARENA_CHUNK_SIZE;
+  ++chunkCount_;
+}
+
+void RequestArena::releaseChunk(ChunkHeader* chunk) {
+  if (chunk->size == ARENA_CHUNK_SIZE) {
+    ArenaChunkPool::release(chunk);
+  } else {
+    std::free(chunk);
+  }
+}
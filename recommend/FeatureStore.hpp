@@ -30,6 +30,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "PoolAllocator.hpp"
+
 // ===================== 特征向量结构 =====================
 
 /**
@@ -142,8 +144,8 @@ template <typename KeyType, typename ValueType> class LRUCache
     explicit LRUCache(size_t capacity) : capacity_(capacity)
     {
         // 创建哨兵节点（虚拟头尾），简化链表操作
-        head_ = std::make_shared<NodeType>(KeyType(), ValueType());
-        tail_ = std::make_shared<NodeType>(KeyType(), ValueType());
+        head_ = std::allocate_shared<NodeType>(PoolAllocator<NodeType>(), KeyType(), ValueType());
+        tail_ = std::allocate_shared<NodeType>(PoolAllocator<NodeType>(), KeyType(), ValueType());
         head_->next = tail_;
         tail_->prev = head_;
     }
@@ -187,7 +189,8 @@ template <typename KeyType, typename ValueType> class LRUCache
         }
 
         // 插入新节点
-        auto newNode = std::make_shared<NodeType>(key, value);
+        // 节点（含 shared_ptr 控制块）与哈希表节点都是小对象，从内存池分配
+        auto newNode = std::allocate_shared<NodeType>(PoolAllocator<NodeType>(), key, value);
         cache_[key] = newNode;
         insertToHead(newNode);
 
@@ -260,7 +263,7 @@ template <typename KeyType, typename ValueType> class LRUCache
     size_t capacity_;
     std::shared_ptr<NodeType> head_;                               // 链表头（虚拟）
     std::shared_ptr<NodeType> tail_;                               // 链表尾（虚拟）
-    std::unordered_map<KeyType, std::shared_ptr<NodeType>> cache_; // 哈希表索引
+    PooledUnorderedMap<KeyType, std::shared_ptr<NodeType>> cache_; // 哈希表索引
 };
 
 // ===================== 特征存储服务 =====================
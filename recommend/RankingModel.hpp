@@ -38,6 +38,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <memory_resource>
 #include <vector>
 
 // ===================== 召回候选结构 =====================
@@ -308,16 +309,17 @@ class RankingEngine
      * @param userId 用户ID
      * @param candidates 召回候选列表
      * @param topK 最终返回的物品数量
-     * @return 排序后的物品分数对（itemId, score）
+     * @return 排序后的物品分数对（itemId, score），与候选列表使用同一内存资源
      */
-    std::vector<std::pair<uint64_t, double>> rankCandidates(uint64_t userId,
-                                                            const std::vector<RecallCandidate> &candidates, int topK)
+    std::pmr::vector<std::pair<uint64_t, double>> rankCandidates(uint64_t userId,
+                                                                 const std::pmr::vector<RecallCandidate> &candidates,
+                                                                 int topK)
     {
-        std::vector<std::pair<uint64_t, double>> results;
+        std::pmr::vector<std::pair<uint64_t, double>> itemScores(candidates.get_allocator());
 
         // 特殊处理：如果候选为空，直接返回
         if (candidates.empty())
-            return results;
+            return itemScores;
 
         // 限制topK不超过候选数量
         topK = std::min(topK, static_cast<int>(candidates.size()));
@@ -326,7 +328,6 @@ class RankingEngine
         FeatureVector userFeature = featureStore_->getUserFeature(userId);
 
         // 对每个候选物品计算排序分数
-        std::vector<std::pair<uint64_t, double>> itemScores;
         itemScores.reserve(candidates.size());
 
         for (const auto &candidate : candidates)
@@ -350,10 +351,10 @@ class RankingEngine
         std::sort(itemScores.begin(), itemScores.end(),
                   [](const auto &a, const auto &b) { return a.second > b.second; });
 
-        // 返回Top-K
-        results.assign(itemScores.begin(), itemScores.begin() + topK);
+        // 返回Top-K：原地截断，不再复制到新的数组
+        itemScores.resize(topK);
 
-        return results;
+        return itemScores;
     }
 
     /**
@@ -26,8 +26,11 @@
  *   {"items": [{"id":1001,"score":0.95,"reason":"猜你喜欢"}, ...], "trace_id":"abc123"}
  */
 
+#include <charconv>
 #include <chrono>
 #include <cstdint>
+#include <cstdio>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -136,26 +139,55 @@ struct RecommendRequest
  */
 struct RecommendItem
 {
-    uint64_t itemId = 0;      // 物品ID
-    double score = 0.0;       // 推荐分数（精排模型输出）
-    std::string category;     // 物品类目（如 "electronics", "food", "video"）
-    std::string reason;       // 推荐理由（用于前端展示，如"猜你喜欢"、"热门推荐"）
-    std::string recallSource; // 召回来源标识（如 "cf" 协同过滤、"hot" 热门、"i2i" 相似推荐）
+    // 支持 uses-allocator 构造：放进 std::pmr::vector 时字符串与容器使用同一个内存资源（如请求 arena）
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    uint64_t itemId = 0;           // 物品ID
+    double score = 0.0;            // 推荐分数（精排模型输出）
+    std::pmr::string category;     // 物品类目（如 "electronics", "food", "video"）
+    std::pmr::string reason;       // 推荐理由（用于前端展示，如"猜你喜欢"、"热门推荐"）
+    std::pmr::string recallSource; // 召回来源标识（如 "cf" 协同过滤、"hot" 热门、"i2i" 相似推荐）
+
+    RecommendItem() = default;
+    explicit RecommendItem(const allocator_type &alloc) : category(alloc), reason(alloc), recallSource(alloc)
+    {
+    }
+    RecommendItem(const RecommendItem &other, const allocator_type &alloc)
+        : itemId(other.itemId), score(other.score), category(other.category, alloc), reason(other.reason, alloc),
+          recallSource(other.recallSource, alloc)
+    {
+    }
+    RecommendItem(RecommendItem &&other, const allocator_type &alloc)
+        : itemId(other.itemId), score(other.score), category(std::move(other.category), alloc),
+          reason(std::move(other.reason), alloc), recallSource(std::move(other.recallSource), alloc)
+    {
+    }
+    RecommendItem(const RecommendItem &) = default;
+    RecommendItem(RecommendItem &&) = default;
+    RecommendItem &operator=(const RecommendItem &) = default;
+    RecommendItem &operator=(RecommendItem &&) = default;
 
     /**
-     * @brief 将物品序列化为JSON字符串
-     * @return JSON格式字符串
+     * @brief 将物品序列化为JSON并追加到 out
+     *
+     * 直接写入调用方的字符串，不为每个字段构造临时 std::string。
+     * @param out 输出字符串（通常是响应 JSON，与请求 arena 同一内存资源）
      */
-    std::string toJson() const
+    void appendJson(std::pmr::string &out) const
     {
-        std::string json = "{";
-        json += "\"id\":" + std::to_string(itemId);
-        json += ",\"score\":" + std::to_string(score);
-        json += ",\"category\":\"" + category + "\"";
-        json += ",\"reason\":\"" + reason + "\"";
-        json += ",\"source\":\"" + recallSource + "\"";
-        json += "}";
-        return json;
+        char num[32];
+        out += "{\"id\":";
+        out.append(num, std::to_chars(num, num + sizeof(num), itemId).ptr);
+        // 与 std::to_string(double) 相同的 %f 格式
+        out += ",\"score\":";
+        out.append(num, std::snprintf(num, sizeof(num), "%f", score));
+        out += ",\"category\":\"";
+        out += category;
+        out += "\",\"reason\":\"";
+        out += reason;
+        out += "\",\"source\":\"";
+        out += recallSource;
+        out += "\"}";
     }
 };
 
@@ -172,8 +204,10 @@ struct RecommendItem
  */
 struct RecommendResponse
 {
-    std::vector<RecommendItem> items; // 推荐结果列表（已排序）
-    std::string traceId;              // 全链路追踪ID
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::vector<RecommendItem> items; // 推荐结果列表（已排序）
+    std::string traceId;                   // 全链路追踪ID
 
     // ---- 全链路性能指标（微秒级） ----
     int64_t recallLatencyUs = 0;  // 召回阶段耗时（微秒）
@@ -183,38 +217,62 @@ struct RecommendResponse
     int recallCandidateCount = 0; // 召回候选数量
     int finalCount = 0;           // 最终返回数量
 
+    RecommendResponse() = default;
+    // 结果列表从 alloc 的内存资源（如请求 arena）分配；移动赋值时双方资源相同才是 O(1) 的指针交换
+    explicit RecommendResponse(const allocator_type &alloc) : items(alloc)
+    {
+    }
+
     /**
      * @brief 将完整响应序列化为JSON字符串
      *
      * 包含推荐结果和全链路性能耗时，方便客户端展示和调试。
+     * @param mr 结果字符串使用的内存资源，默认与 items 相同
      * @return JSON格式响应字符串
      */
-    std::string toJson() const
+    std::pmr::string toJson() const
     {
-        std::string json = "{\"items\":[";
+        return toJson(items.get_allocator().resource());
+    }
+    std::pmr::string toJson(std::pmr::memory_resource *mr) const
+    {
+        std::pmr::string json(mr);
+        // 按每个物品约 128 字节预留，避免单调分配器上反复扩容留下废弃的旧缓冲区
+        json.reserve(256 + items.size() * 128);
+        json += "{\"items\":[";
 
         // 序列化每个推荐物品
         for (size_t i = 0; i < items.size(); i++)
         {
             if (i > 0)
                 json += ",";
-            json += items[i].toJson();
+            items[i].appendJson(json);
         }
 
-        json += "],\"trace_id\":\"" + traceId + "\"";
+        json += "],\"trace_id\":\"";
+        json += traceId;
+        json += "\"";
 
         // 附加性能指标（搜广推系统的关键监控数据）
         json += ",\"latency\":{";
-        json += "\"recall_us\":" + std::to_string(recallLatencyUs);
-        json += ",\"feature_us\":" + std::to_string(featureLatencyUs);
-        json += ",\"rank_us\":" + std::to_string(rankLatencyUs);
-        json += ",\"total_us\":" + std::to_string(totalLatencyUs);
+        appendField(json, "\"recall_us\":", recallLatencyUs);
+        appendField(json, ",\"feature_us\":", featureLatencyUs);
+        appendField(json, ",\"rank_us\":", rankLatencyUs);
+        appendField(json, ",\"total_us\":", totalLatencyUs);
         json += "}";
 
-        json += ",\"recall_count\":" + std::to_string(recallCandidateCount);
-        json += ",\"final_count\":" + std::to_string(finalCount);
+        appendField(json, ",\"recall_count\":", recallCandidateCount);
+        appendField(json, ",\"final_count\":", finalCount);
         json += "}";
 
         return json;
     }
+
+  private:
+    static void appendField(std::pmr::string &out, std::string_view key, int64_t value)
+    {
+        char num[24];
+        out += key;
+        out.append(num, std::to_chars(num, num + sizeof(num), value).ptr);
+    }
 };
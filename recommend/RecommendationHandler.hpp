@@ -31,6 +31,7 @@
 #include "RankingModel.hpp"
 #include "RecommendProtocol.hpp"
 #include <chrono>
+#include <memory_resource>
 #include <vector>
 
 // ===================== 推荐处理器 =====================
@@ -58,13 +59,20 @@ class RecommendationHandler
      *   5. 重排阶段：应用多样性等规则（这里简化掉）
      *   6. 构建响应：包含推荐结果和性能指标
      *
+     * 召回候选、排序结果和响应中的物品列表都从 mr 分配：传入请求 arena 时，
+     * 整个请求的临时对象在 arena 析构时一次性释放，不再逐个 free。
+     *
      * @param request 推荐请求
+     * @param mr 本次请求的内存资源（通常是 RequestArena），返回的响应也使用它
      * @return 推荐响应
      */
-    RecommendResponse handleRecommendation(const RecommendRequest &request)
+    RecommendResponse handleRecommendation(const RecommendRequest &request,
+                                           std::pmr::memory_resource *mr = std::pmr::get_default_resource())
     {
-        auto startTime = std::chrono::high_resolution_clock::now();
-        RecommendResponse response;
+        // 分阶段耗时需要精确计时（本函数通常在计算线程池执行，没有 Loop 时钟快照），
+        // 用单调时钟并让相邻阶段共用边界时间点，每个请求只读 4 次时钟
+        auto startTime = std::chrono::steady_clock::now();
+        RecommendResponse response(mr);
         response.traceId = request.traceId;
 
         // ==================== 1. 参数校验 ====================
@@ -76,11 +84,11 @@ class RecommendationHandler
         }
 
         // ==================== 2. 召回阶段 ====================
-        auto recallStartTime = std::chrono::high_resolution_clock::now();
+        auto recallStartTime = startTime;
 
-        std::vector<RecallCandidate> candidates = recall(request.userId, request.scene);
+        std::pmr::vector<RecallCandidate> candidates = recall(request.userId, request.scene, mr);
 
-        auto recallEndTime = std::chrono::high_resolution_clock::now();
+        auto recallEndTime = std::chrono::steady_clock::now();
         response.recallLatencyUs =
             std::chrono::duration_cast<std::chrono::microseconds>(recallEndTime - recallStartTime).count();
         response.recallCandidateCount = static_cast<int>(candidates.size());
@@ -93,40 +101,41 @@ class RecommendationHandler
         }
 
         // ==================== 3. 特征阶段 ====================
-        auto featureStartTime = std::chrono::high_resolution_clock::now();
+        auto featureStartTime = recallEndTime;
 
         // 在这个demo中，特征获取在rank()阶段完成
         // 真实系统可能在此阶段并行获取多个特征
 
-        auto featureEndTime = std::chrono::high_resolution_clock::now();
+        auto featureEndTime = featureStartTime;
         response.featureLatencyUs =
             std::chrono::duration_cast<std::chrono::microseconds>(featureEndTime - featureStartTime).count();
 
         // ==================== 4. 排序阶段 ====================
-        auto rankStartTime = std::chrono::high_resolution_clock::now();
+        auto rankStartTime = featureEndTime;
 
         // 对候选进行排序，返回Top-K
         int topK = std::min(request.count, static_cast<int>(candidates.size()));
         auto rankedItems = rankingEngine_->rankCandidates(request.userId, candidates, topK);
 
-        auto rankEndTime = std::chrono::high_resolution_clock::now();
+        auto rankEndTime = std::chrono::steady_clock::now();
         response.rankLatencyUs =
             std::chrono::duration_cast<std::chrono::microseconds>(rankEndTime - rankStartTime).count();
 
         // ==================== 5. 构建响应 ====================
+        response.items.reserve(rankedItems.size());
         for (const auto &item : rankedItems)
         {
-            RecommendItem recItem;
+            // 原地构造：物品的字符串随容器从同一内存资源分配
+            RecommendItem &recItem = response.items.emplace_back();
             recItem.itemId = item.first;
             recItem.score = item.second;
             recItem.category = getCategoryFromItemId(item.first);
             recItem.reason = getReasonFromScene(request.scene);
-            response.items.push_back(recItem);
         }
 
         response.finalCount = static_cast<int>(response.items.size());
 
-        auto endTime = std::chrono::high_resolution_clock::now();
+        auto endTime = std::chrono::steady_clock::now();
         response.totalLatencyUs = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
 
         return response;
@@ -146,11 +155,14 @@ class RecommendationHandler
      *
      * @param userId 用户ID
      * @param scene 推荐场景
+     * @param mr 候选列表使用的内存资源
      * @return 召回候选列表
      */
-    std::vector<RecallCandidate> recall(uint64_t userId, const std::string &scene)
+    std::pmr::vector<RecallCandidate> recall(uint64_t userId, const std::string &scene,
+                                             std::pmr::memory_resource *mr)
     {
-        std::vector<RecallCandidate> candidates;
+        std::pmr::vector<RecallCandidate> candidates(mr);
+        candidates.reserve(100);
 
         // 生成100个候选物品（模拟召回结果）
         // 真实系统召回数量可能从几百到几千
@@ -194,7 +206,7 @@ class RecommendationHandler
      * @param scene 推荐场景
      * @return 推荐理由文本
      */
-    std::string getReasonFromScene(const std::string &scene) const
+    std::string_view getReasonFromScene(const std::string &scene) const
     {
         if (scene == "homepage")
             return "猜你喜欢";
@@ -214,7 +226,7 @@ class RecommendationHandler
      * @param itemId 物品ID
      * @return 物品分类标签
      */
-    std::string getCategoryFromItemId(uint64_t itemId) const
+    std::string_view getCategoryFromItemId(uint64_t itemId) const
     {
         // 简单的模拟：根据ID取模映射到几个分类
         int categoryIdx = itemId % 5;
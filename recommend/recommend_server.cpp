@@ -20,23 +20,30 @@
  */
 
 #include <chrono>
+#include <csignal>
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <random>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <pthread.h>
 #include <thread>
 
+#include "AllocProfiler.hpp"
+#include "ComputePool.hpp"
 #include "Config.hpp"
 #include "CoroutineTask.hpp"
 #include "EventLoop.hpp"
 #include "InetAddress.hpp"
 #include "Logger.hpp"
 #include "MemoryPool.hpp"
+#include "RequestArena.hpp"
 #include "TcpConnection.hpp"
 #include "TcpServer.hpp"
+#include "TimerQueue.hpp"
 
 #include "FeatureStore.hpp"
 #include "RankingModel.hpp"
@@ -49,6 +56,10 @@
 std::unique_ptr<FeatureStore> g_featureStore;
 // 推荐处理器
 std::unique_ptr<RecommendationHandler> g_recommendationHandler;
+// 排序计算线程池（recommend.compute_threads > 0 时创建），为空时在 IO Loop 上直接计算
+std::unique_ptr<ComputePool> g_computePool;
+// 单个请求的响应时限（从解析出完整请求开始计时），0 表示不限制
+std::chrono::milliseconds g_responseDeadline{0};
 
 // ===================== 工具函数 =====================
 
@@ -225,16 +236,20 @@ struct HttpRequest
  * @param body 响应体内容
  * @param contentType MIME类型（如application/json）
  * @param keepAlive 是否keep-alive
+ * @param mr 响应字符串使用的内存资源（请求 arena）
  * @return HTTP响应字符串
  */
-std::string buildHttpResponse(std::string_view body, const std::string &contentType = "application/json",
-                              bool keepAlive = true)
+std::pmr::string buildHttpResponse(std::string_view body, std::string_view contentType = "application/json",
+                                   bool keepAlive = true,
+                                   std::pmr::memory_resource *mr = std::pmr::get_default_resource())
 {
-    std::string response;
+    std::pmr::string response(mr);
     response.reserve(512 + body.size());
 
     response += "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Type: ";
+    response += contentType;
+    response += "\r\n";
     response += "Content-Length: ";
     response += std::to_string(body.size());
     response += "\r\n";
@@ -249,10 +264,123 @@ std::string buildHttpResponse(std::string_view body, const std::string &contentT
 /**
  * @brief 构建错误响应
  */
-std::string buildErrorResponse(const std::string &error, bool keepAlive = true)
+std::pmr::string buildErrorResponse(std::string_view error, bool keepAlive = true,
+                                    std::pmr::memory_resource *mr = std::pmr::get_default_resource())
 {
-    std::string body = R"({"error":")" + error + R"("})";
-    return buildHttpResponse(body, "application/json", keepAlive);
+    std::pmr::string body(mr);
+    body += R"({"error":")";
+    body += error;
+    body += R"("})";
+    return buildHttpResponse(body, "application/json", keepAlive, mr);
+}
+
+/**
+ * @brief 内存池各大小类别的统计（只输出申请过内存块的类别）
+ */
+std::string buildMemoryPoolStatsJson()
+{
+    std::string json = R"({"classes":[)";
+    size_t totalBlocks = 0;
+    size_t totalBytes = 0;
+    bool first = true;
+    for (const MemoryPool::Stats &stats : HashBucket::getStats())
+    {
+        if (stats.blocks == 0 && stats.purgedBlocks == 0)
+        {
+            continue;
+        }
+        totalBlocks += stats.blocks;
+        totalBytes += stats.blocks * stats.blockSize;
+        json += fmt::format(R"({}{{"slot_size":{},"block_size":{},"blocks":{},"purged_blocks":{},"live":{},)"
+                            R"("free":{},"released_bytes":{},"fragmentation":{:.3f}}})",
+                            first ? "" : ",", stats.slotSize, stats.blockSize, stats.blocks, stats.purgedBlocks,
+                            stats.liveSlots, stats.freeSlots, stats.releasedBytes, stats.fragmentation);
+        first = false;
+    }
+    json += fmt::format(R"(],"blocks":{},"bytes":{}}})", totalBlocks, totalBytes);
+    return json;
+}
+
+/**
+ * @brief 内存池分配剖析：各类别持有数与峰值（只输出分配过的类别），以及持有量最大的调用点
+ */
+std::string buildAllocProfileJson(size_t maxSites = 20)
+{
+    AllocProfiler::Report report = AllocProfiler::report(maxSites);
+    std::string json = fmt::format(R"({{"enabled":{},"sample_interval":{},"live_samples":{},"total_samples":{},)"
+                                   R"("classes":[)",
+                                   report.enabled, report.sampleInterval, report.liveSamples, report.totalSamples);
+    bool first = true;
+    for (const AllocProfiler::ClassStats &stats : report.classes)
+    {
+        if (stats.allocations == 0)
+        {
+            continue;
+        }
+        json += fmt::format(R"({}{{"slot_size":{},"allocations":{},"deallocations":{},"live":{},"high_water":{},)"
+                            R"("live_bytes":{}}})",
+                            first ? "" : ",", stats.slotSize, stats.allocations, stats.deallocations, stats.live,
+                            stats.highWater, stats.liveBytes);
+        first = false;
+    }
+    json += R"(],"sites":[)";
+    for (size_t i = 0; i < report.sites.size(); ++i)
+    {
+        const AllocProfiler::Site &site = report.sites[i];
+        json += fmt::format(R"({}{{"samples":{},"sampled_bytes":{},"estimated_bytes":{},"oldest_age_ms":{},"frames":[)",
+                            i > 0 ? "," : "", site.samples, site.sampledBytes, site.estimatedBytes,
+                            site.oldestAge.count());
+        for (size_t j = 0; j < site.frames.size(); ++j)
+        {
+            // 符号名可能包含引号、反斜杠（模板实参中的字符串字面量），按 JSON 转义
+            json += j > 0 ? ",\"" : "\"";
+            for (char c : site.frames[j])
+            {
+                if (c == '"' || c == '\\')
+                {
+                    json += '\\';
+                }
+                json += c;
+            }
+            json += '"';
+        }
+        json += "]}";
+    }
+    json += "]}";
+    return json;
+}
+
+/**
+ * @brief 把分配剖析写入日志（SIGUSR2 触发）
+ */
+void logAllocProfile()
+{
+    if (!AllocProfiler::enabled())
+    {
+        LOG_WARN("Alloc profile requested but memory.profile is disabled");
+        return;
+    }
+    AllocProfiler::Report report = AllocProfiler::report(20);
+    LOG_INFO("Alloc profile: sample_interval={}, live_samples={}, total_samples={}", report.sampleInterval,
+             report.liveSamples, report.totalSamples);
+    for (const AllocProfiler::ClassStats &stats : report.classes)
+    {
+        if (stats.allocations == 0)
+        {
+            continue;
+        }
+        LOG_INFO("  class slot_size={}: live={}, high_water={}, live_bytes={}, allocations={}", stats.slotSize,
+                 stats.live, stats.highWater, stats.liveBytes, stats.allocations);
+    }
+    for (const AllocProfiler::Site &site : report.sites)
+    {
+        LOG_INFO("  site estimated_bytes={}, samples={}, oldest_age_ms={}", site.estimatedBytes, site.samples,
+                 site.oldestAge.count());
+        for (const std::string &frame : site.frames)
+        {
+            LOG_INFO("    {}", frame);
+        }
+    }
 }
 
 // ===================== 推荐服务协程处理器 =====================
@@ -271,7 +399,7 @@ std::string buildErrorResponse(const std::string &error, bool keepAlive = true)
  *
  * @param conn TCP连接对象
  */
-Task recommendationServiceTask(std::shared_ptr<TcpConnection> conn)
+DetachedTask recommendationServiceTask(std::shared_ptr<TcpConnection> conn)
 {
     try
     {
@@ -279,6 +407,15 @@ Task recommendationServiceTask(std::shared_ptr<TcpConnection> conn)
 
         while (true)
         {
+            // 服务器正在排空：当前没有未处理完的请求，关闭连接，不再等待下一个请求
+            if (buffer.empty() && conn->isDraining())
+            {
+                LOG_DEBUG("Server draining, closing idle connection: {}", conn->getName());
+                break;
+            }
+            // 缓冲区为空说明处于请求边界，这次读只是在等待下一个请求，排空开始时可以直接取消
+            conn->setAwaitingRequest(buffer.empty());
+
             // ============ 1. 异步读取数据 ============
             // co_await会触发异步读操作，协程在I/O完成后自动恢复
             int n = co_await conn->asyncRead(4096);
@@ -312,7 +449,14 @@ Task recommendationServiceTask(std::shared_ptr<TcpConnection> conn)
                 }
 
                 // ============ 4. 处理推荐请求 ============
-                std::string responseBody;
+                // 请求级时限由 IO 层的 LINK_TIMEOUT 执行：响应在截止时间前没有写完，发送以 kDeadlineExceeded 返回
+                Deadline deadline = g_responseDeadline > std::chrono::milliseconds::zero()
+                                        ? deadlineAfter(g_responseDeadline)
+                                        : kNoDeadline;
+                // 请求级 arena：召回候选、排序结果、响应 JSON 和 HTTP 报文都从这里分配，
+                // 发送完成后随 arena 析构一次性归还本 Loop 的块池
+                RequestArena arena;
+                std::pmr::string responseBody(&arena);
 
                 if (req.path == "/recommend" && req.method == "POST")
                 {
@@ -321,7 +465,7 @@ Task recommendationServiceTask(std::shared_ptr<TcpConnection> conn)
                     if (!request.parseFromJson(req.body))
                     {
                         LOG_WARN("Failed to parse recommend request: {}", req.body);
-                        responseBody = buildErrorResponse("Invalid request format", req.keepAlive);
+                        responseBody = buildErrorResponse("Invalid request format", req.keepAlive, &arena);
                     }
                     else
                     {
@@ -333,7 +477,21 @@ Task recommendationServiceTask(std::shared_ptr<TcpConnection> conn)
                                   request.userId, request.count, request.scene, request.traceId);
 
                         auto startTime = std::chrono::high_resolution_clock::now();
-                        RecommendResponse response = g_recommendationHandler->handleRecommendation(request);
+                        // 与处理器返回的响应使用同一个 arena，赋值只交换指针
+                        RecommendResponse response(&arena);
+                        if (g_computePool)
+                        {
+                            // 召回/排序是 CPU 密集计算：转到计算线程池执行，避免阻塞同一 Loop 上其他连接的 IO，
+                            // 完成后回到连接所属的 IO Loop 发送响应
+                            EventLoop *ioLoop = conn->getLoop();
+                            co_await g_computePool->schedule();
+                            response = g_recommendationHandler->handleRecommendation(request, &arena);
+                            co_await ioLoop->schedule();
+                        }
+                        else
+                        {
+                            response = g_recommendationHandler->handleRecommendation(request, &arena);
+                        }
                         auto endTime = std::chrono::high_resolution_clock::now();
 
                         int handlerLatencyUs =
@@ -345,13 +503,13 @@ Task recommendationServiceTask(std::shared_ptr<TcpConnection> conn)
                                  request.userId, response.recallCandidateCount, response.finalCount,
                                  response.totalLatencyUs, handlerLatencyUs);
 
-                        responseBody = buildHttpResponse(response.toJson(), "application/json", req.keepAlive);
+                        responseBody = buildHttpResponse(response.toJson(), "application/json", req.keepAlive, &arena);
                     }
                 }
                 else if (req.path == "/health")
                 {
                     // 健康检查接口
-                    responseBody = buildHttpResponse(R"({"status":"ok"})", "application/json", req.keepAlive);
+                    responseBody = buildHttpResponse(R"({"status":"ok"})", "application/json", req.keepAlive, &arena);
                 }
                 else if (req.path == "/stats")
                 {
@@ -359,17 +517,31 @@ Task recommendationServiceTask(std::shared_ptr<TcpConnection> conn)
                     auto stats = g_featureStore->getCacheStats();
                     std::string statsJson = R"({"feature_cache":{"user_hit_rate":)" +
                                             std::to_string(stats.userHitRate) + R"(,"item_hit_rate":)" +
-                                            std::to_string(stats.itemHitRate) + R"(}})";
-                    responseBody = buildHttpResponse(statsJson, "application/json", req.keepAlive);
+                                            std::to_string(stats.itemHitRate) + R"(},"memory_pool":)" +
+                                            buildMemoryPoolStatsJson() + "}";
+                    responseBody = buildHttpResponse(statsJson, "application/json", req.keepAlive, &arena);
+                }
+                else if (req.path == "/memory_profile")
+                {
+                    // 内存池分配剖析：各大小类别的持有数/峰值与持有最多的调用点
+                    responseBody = buildHttpResponse(buildAllocProfileJson(), "application/json", req.keepAlive, &arena);
                 }
                 else
                 {
                     // 404 Not Found
-                    responseBody = buildErrorResponse("Not Found", req.keepAlive);
+                    responseBody = buildErrorResponse("Not Found", req.keepAlive, &arena);
                 }
 
                 // ============ 5. 异步发送响应 ============
-                int written = co_await conn->asyncSend(responseBody);
+                int written = co_await conn->asyncSend(responseBody.data(), responseBody.size(), deadline);
+                if (written == kDeadlineExceeded)
+                {
+                    // 响应超时：客户端已按超时处理，连接上的后续响应无法再与请求对齐，直接关闭
+                    LOG_WARN("Response deadline exceeded: fd={}, deadline_ms={}", conn->getName(),
+                             g_responseDeadline.count());
+                    conn->forceClose();
+                    co_return;
+                }
                 if (written < 0)
                 {
                     LOG_ERROR("Failed to send response: fd={}, written={}", conn->getName(), written);
@@ -412,6 +584,15 @@ int main(int argc, char **argv)
         configPath = argv[1];
     }
 
+    // 在创建任何线程之前屏蔽 SIGTERM/SIGINT，由专门的信号线程同步等待，触发优雅关闭
+    sigset_t shutdownSignals;
+    sigemptyset(&shutdownSignals);
+    sigaddset(&shutdownSignals, SIGTERM);
+    sigaddset(&shutdownSignals, SIGINT);
+    // SIGUSR2：把内存池分配剖析输出到日志（需开启 memory.profile）
+    sigaddset(&shutdownSignals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &shutdownSignals, nullptr);
+
     // ==================== 初始化日志系统 ====================
     Logger::Options logOptions;
     Logger::init(logOptions);
@@ -454,7 +635,17 @@ int main(int argc, char **argv)
 
     // ==================== 初始化内存池 ====================
     LOG_DEBUG("Initializing memory pool...");
-    HashBucket::initMemoryPool();
+    HashBucket::Options poolOptions;
+    poolOptions.slotsPerBlock = config.getSizeT("memory.slots_per_block", poolOptions.slotsPerBlock);
+    poolOptions.minBlockSize = config.getSizeT("memory.min_block_size", poolOptions.minBlockSize);
+    poolOptions.maxBlockSize = config.getSizeT("memory.max_block_size", poolOptions.maxBlockSize);
+    poolOptions.hugePages = config.getBool("memory.huge_pages", poolOptions.hugePages);
+    poolOptions.retainFreeBlocks = config.getSizeT("memory.retain_free_blocks", poolOptions.retainFreeBlocks);
+    poolOptions.trimFreeRatio = config.getInt("memory.trim_free_percent", 50) / 100.0;
+    poolOptions.profiling = config.getBool("memory.profile", poolOptions.profiling);
+    poolOptions.profileSampleInterval =
+        config.getSizeT("memory.profile_sample_interval", poolOptions.profileSampleInterval);
+    HashBucket::initMemoryPool(poolOptions);
     LOG_DEBUG("Memory pool initialized successfully.");
 
     // ==================== 初始化EventLoop ====================
@@ -470,6 +661,13 @@ int main(int argc, char **argv)
         config.getSizeT("event_loop.registered_buffer_size", loopOptions.registeredBuffersSize);
     loopOptions.pendingQueueCapacity =
         config.getSizeT("event_loop.pending_queue_capacity", loopOptions.pendingQueueCapacity);
+    loopOptions.idleWheelTick = config.getDurationMs("event_loop.idle_wheel_tick_ms", loopOptions.idleWheelTick);
+    loopOptions.idleWheelSlots = config.getSizeT("event_loop.idle_wheel_slots", loopOptions.idleWheelSlots);
+    loopOptions.connectionPoolCapacity =
+        config.getSizeT("event_loop.connection_pool_capacity", loopOptions.connectionPoolCapacity);
+    loopOptions.timerTick = config.getDurationMs("event_loop.timer_tick_ms", loopOptions.timerTick);
+    loopOptions.timerSlack = config.getDurationMs("event_loop.timer_slack_ms", loopOptions.timerSlack);
+    loopOptions.coarseClock = config.getBool("event_loop.coarse_clock", loopOptions.coarseClock);
 
     EventLoop loop(loopOptions);
     LOG_DEBUG("EventLoop created.");
@@ -490,6 +688,13 @@ int main(int argc, char **argv)
     // 创建推荐处理器
     g_recommendationHandler = std::make_unique<RecommendationHandler>(g_featureStore.get());
     LOG_INFO("RecommendationHandler initialized.");
+    g_responseDeadline = config.getDurationMs("recommend.response_deadline_ms", g_responseDeadline);
+    size_t computeThreads = config.getSizeT("recommend.compute_threads", 0);
+    if (computeThreads > 0)
+    {
+        g_computePool = std::make_unique<ComputePool>(computeThreads);
+        g_computePool->start();
+    }
 
     // ==================== 创建TcpServer ====================
     std::string listenIp = config.getString("server.ip", "0.0.0.0");
@@ -517,6 +722,12 @@ int main(int argc, char **argv)
     server.setThreadNum(threadNum);
     server.setEventLoopOptions(loopOptions);
     server.setReadTimeout(config.getDurationMs("server.read_timeout_ms", std::chrono::milliseconds(5000)));
+    // 空闲超时机制：link_timeout（每次读链接一个内核定时器）或 timing_wheel（每个 Loop 一个时间轮批量清理）
+    if (config.getString("server.idle_timeout_mode", "link_timeout") == "timing_wheel")
+    {
+        server.setIdleTimeoutMode(IdleTimeoutMode::kTimingWheel);
+    }
+    server.setWriteCorking(config.getBool("server.write_corking", false));
 
     server.start();
     LOG_INFO("RecommendationService started on {}:{} with {} worker threads.", listenIp, listenPort, threadNum);
@@ -524,13 +735,53 @@ int main(int argc, char **argv)
     LOG_INFO("  POST /recommend      - Get recommendations");
     LOG_INFO("  GET  /health         - Health check");
     LOG_INFO("  GET  /stats          - Performance stats");
+    LOG_INFO("  GET  /memory_profile - Memory pool allocation profile (memory.profile, or kill -USR2 to log it)");
+
+    // ==================== 优雅关闭 ====================
+    // 收到 SIGTERM/SIGINT 后停止监听，等待处理中的请求完成（最长 drain_timeout_ms），之后退出事件循环
+    std::chrono::milliseconds drainTimeout =
+        config.getDurationMs("server.drain_timeout_ms", std::chrono::milliseconds(10000));
+    std::thread signalThread([&server, &loop, shutdownSignals, drainTimeout]() {
+        int sig = 0;
+        while (sigwait(&shutdownSignals, &sig) == 0 && sig == SIGUSR2)
+        {
+            logAllocProfile();
+        }
+        LOG_INFO("Received signal {}, draining connections (timeout_ms={})...", sig, drainTimeout.count());
+        server.drain(drainTimeout, [&loop](const TcpServer::DrainStats &stats) {
+            LOG_INFO("Drain finished: total={}, idle_closed={}, drained={}, cancelled={}, elapsed_ms={}", stats.total,
+                     stats.idleClosed, stats.drained, stats.cancelled, stats.elapsed.count());
+            loop.quit();
+        });
+    });
+
+    // ==================== 内存池回收 ====================
+    // 周期性地把流量高峰后全部空闲的内存块归还给 OS，避免进程常驻内存停留在峰值
+    std::chrono::milliseconds trimInterval =
+        config.getDurationMs("memory.trim_interval_ms", std::chrono::milliseconds(30000));
+    if (trimInterval.count() > 0)
+    {
+        loop.getTimerQueue().runEvery(trimInterval, []() {
+            size_t released = HashBucket::trim();
+            if (released > 0)
+            {
+                LOG_INFO("Memory pool trimmed: released_bytes={}", released);
+            }
+        });
+    }
 
     // ==================== 进入事件循环 ====================
     LOG_DEBUG("Entering event loop...");
     loop.loop();
     LOG_INFO("Event loop exited.");
+    // 事件循环只会因排空完成而退出，此时信号线程已经返回
+    signalThread.join();
 
     // ==================== 清理资源 ====================
+    if (g_computePool)
+    {
+        g_computePool->stop();
+    }
     g_recommendationHandler.reset();
     g_featureStore.reset();
     Logger::shutdown();
@@ -40,10 +40,7 @@ Acceptor::Acceptor(EventLoop *loop, const InetAddress &listenAddr, bool reusepor
 
 Acceptor::~Acceptor()
 {
-    if (listening_)
-    {
-        ::close(listenSocket_.getFd());
-    }
+    // 监听 Socket 由 listenSocket_ 析构时关闭（stop 之后已关闭则不会重复关闭）
 }
 
 void Acceptor::listen()
@@ -53,6 +50,18 @@ void Acceptor::listen()
     asyncAccept(); // 提交第一个 accept 请求
 }
 
+void Acceptor::stop()
+{
+    if (!listening_)
+    {
+        return;
+    }
+    listening_ = false;
+    // accept 请求持有监听 Socket 的引用，只关闭 fd 不会让它结束，先按 user_data 取消
+    acceptLoop_->cancelIo(&acceptContext_);
+    listenSocket_.closeFd();
+}
+
 void Acceptor::asyncAccept()
 {
     // 获取 SQE
@@ -0,0 +1,129 @@
+#include "AsyncFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+
+#include "Logger.hpp"
+
+bool FileReadBatchAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    handle_ = handle;
+    slots_.reset(new Slot[ops_.size()]);
+    for (size_t i = 0; i < ops_.size(); ++i)
+    {
+        FileReadOp &op = ops_[i];
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&loop_->ring_);
+        if (!sqe)
+        {
+            // 批量大于 SQ 剩余空间：先提交已准备好的部分，腾出 SQ 后继续
+            io_uring_submit(&loop_->ring_);
+            sqe = io_uring_get_sqe(&loop_->ring_);
+        }
+        if (!sqe)
+        {
+            LOG_ERROR("FileReadBatchAwaitable: SQ full, op={}", i);
+            op.result = -EBUSY;
+            slots_[i].done = true;
+            continue;
+        }
+        if (op.bufIdx >= 0)
+        {
+            io_uring_prep_read_fixed(sqe, fd_, op.buf, static_cast<unsigned>(op.len), static_cast<__u64>(op.offset),
+                                     op.bufIdx);
+        }
+        else
+        {
+            io_uring_prep_read(sqe, fd_, op.buf, static_cast<unsigned>(op.len), static_cast<__u64>(op.offset));
+        }
+        Slot &slot = slots_[i];
+        // 最后一个完成的请求恢复协程，恢复后不再访问本 Awaitable
+        slot.context.handler = [this, i](int res) {
+            ops_[i].result = res;
+            slots_[i].done = true;
+            if (--remaining_ == 0)
+            {
+                handle_.resume();
+            }
+        };
+        io_uring_sqe_set_data(sqe, &slot.context);
+        ++remaining_;
+    }
+    // 一个都没有提交成功：不挂起
+    return remaining_ > 0;
+}
+
+int FileReadBatchAwaitable::await_resume() const noexcept
+{
+    return static_cast<int>(
+        std::count_if(ops_.begin(), ops_.end(), [](const FileReadOp &op) { return op.result >= 0; }));
+}
+
+void FileReadBatchAwaitable::cancel() noexcept
+{
+    for (size_t i = 0; i < ops_.size(); ++i)
+    {
+        if (slots_ && !slots_[i].done)
+        {
+            loop_->cancelIo(&slots_[i].context);
+        }
+    }
+}
+
+AsyncFile &AsyncFile::operator=(AsyncFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        loop_ = other.loop_;
+        fd_ = std::exchange(other.fd_, -1);
+        direct_ = other.direct_;
+    }
+    return *this;
+}
+
+AsyncFile::~AsyncFile()
+{
+    close();
+}
+
+void AsyncFile::close()
+{
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+Task<int> AsyncFile::readAligned(off_t offset, size_t len, FileBufferView &view)
+{
+    constexpr off_t kMask = static_cast<off_t>(kDirectAlignment - 1);
+    off_t start = offset & ~kMask;
+    size_t head = static_cast<size_t>(offset - start);
+    size_t span = (head + len + kDirectAlignment - 1) & ~(kDirectAlignment - 1);
+    if (span > loop_->getRegisteredBufferSize())
+    {
+        LOG_WARN("AsyncFile::readAligned: span {} exceeds registered buffer size {}", span,
+                 loop_->getRegisteredBufferSize());
+        co_return -EINVAL;
+    }
+    int idx = loop_->getRegisteredBufferIndex();
+    if (idx < 0)
+    {
+        co_return -ENOBUFS;
+    }
+
+    int n = co_await readFixed(start, idx, span);
+    if (n < 0)
+    {
+        loop_->returnRegisteredBuffer(idx);
+        co_return n;
+    }
+    // 读到文件末尾时可能短读，只返回请求范围内实际读到的部分
+    size_t valid = static_cast<size_t>(n) > head ? std::min(len, static_cast<size_t>(n) - head) : 0;
+    view.idx = idx;
+    view.data = static_cast<const char *>(loop_->getRegisteredBuffer(idx)) + head;
+    view.size = valid;
+    co_return static_cast<int>(valid);
+}
@@ -13,12 +13,12 @@ void AsyncReadAwaitable::await_suspend(std::coroutine_handle<> handle) noexcept
     // 提交io_uring读请求
     if (userBuf_ == nullptr)
     {
-        conn_->submitReadRequest(nbytes_);
+        conn_->submitReadRequest(nbytes_, deadline_);
     }
     else
     {
         // 使用用户提供的缓冲区进行读操作
-        conn_->submitReadRequestWithUserBuffer(userBuf_, userBufCap_, nbytes_);
+        conn_->submitReadRequestWithUserBuffer(userBuf_, userBufCap_, nbytes_, deadline_);
     }
     // 返回void表示挂起协程
 }
@@ -27,6 +27,16 @@ int AsyncReadAwaitable::await_resume() const noexcept
 {
     int n = conn_->getReadContext().result_;
     int idx = conn_->getReadContext().idx;
+    if (n == -ECANCELED && deadlineExpired(deadline_))
+    {
+        // 链接的 LINK_TIMEOUT 到期取消了读请求，与主动取消区分开
+        n = kDeadlineExceeded;
+    }
+    if (n > 0)
+    {
+        // 时间轮模式下刷新连接的活跃时间
+        conn_->markActive();
+    }
     if (n > 0 && idx >= 0)
     {
         // 使用已注册缓冲区读取数据成功，不进行拷贝，记录信息
@@ -56,4 +66,9 @@ int AsyncReadAwaitable::await_resume() const noexcept
     }
     // 返回实际读取的字节数，在后续开发中根据此结果进行错误处理
     return n;
-}
\ No newline at end of file
+}
+
+void AsyncReadAwaitable::cancel() noexcept
+{
+    conn_->getLoop()->cancelIo(&conn_->getReadContext());
+}
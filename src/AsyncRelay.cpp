@@ -0,0 +1,20 @@
+#include "AsyncRelay.hpp"
+
+#include "TcpConnection.hpp"
+
+bool AsyncRelayAwaitable::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    // 两段 SQE 在 TcpConnection 中准备，完成后由连接持有的回调恢复协程
+    return conn_->submitLinkedRelay(dstFd_, len_, handle);
+}
+
+int AsyncRelayAwaitable::await_resume() const noexcept
+{
+    // 成功返回中继的字节数；读到 EOF 返回 0；失败返回负的错误码
+    return conn_->getRelayResult();
+}
+
+void AsyncRelayAwaitable::cancel() noexcept
+{
+    conn_->cancelLinkedRelay();
+}
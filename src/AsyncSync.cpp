@@ -0,0 +1,29 @@
+#include "AsyncSync.hpp"
+
+void AsyncMutex::unlock()
+{
+    LockAwaiter *next = waiters_.pop();
+    if (!next)
+    {
+        locked_ = false;
+        return;
+    }
+    // 锁保持持有状态直接移交，避免被恢复前的其他协程抢走
+    next->handle_.resume();
+}
+
+void AsyncSemaphore::release(size_t n)
+{
+    while (n > 0)
+    {
+        AcquireAwaiter *next = waiters_.pop();
+        if (!next)
+        {
+            permits_ += n;
+            return;
+        }
+        --n;
+        // 被恢复的协程可能再次 acquire/release，恢复前先更新好剩余数量
+        next->handle_.resume();
+    }
+}
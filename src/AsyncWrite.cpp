@@ -1,117 +1,109 @@
 #include "AsyncWrite.hpp"
 
+#include <cerrno>
 #include <iostream>
 #include <thread>
 
 #include "Buffer.hpp"
 #include "TcpConnection.hpp"
 
-void AsyncWriteAwaitable::await_suspend(std::coroutine_handle<> handle) noexcept
+bool AsyncWriteAwaitable::await_ready() const noexcept
 {
-    auto &ctx = conn_->getWriteContext();
-
-    // 背压机制：检查是否需要触发 kBlock 阻塞策略（仅对普通模式生效，固定缓冲区模式不经过 outputBuffer_）
-    // 触发条件：未开启固定缓冲区 && 配置了 kBlock 策略 && 发送缓冲区数据量已达到或超过高水位阈值
-    if (regBuf_ == nullptr && conn_->getBackpressureConfig().strategy == BackpressureStrategy::kBlock &&
-        conn_->getOutputBuffer().readableBytes() >= conn_->getBackpressureConfig().outputBufferHighWaterMark)
+    if (!isOutputWrite())
     {
-
-        isBlocked_ = true;
-        // 关键点：将 coro_handle 置空，这样 io_uring 完成事件到来时，不会直接唤醒协程
-        // 而是转而执行下面设置的 handler 回调，从而实现协程的“挂起”
-        ctx.coro_handle = nullptr;
-
-        // 设置一个循环处理的 handler，由底层 EventLoop 在每次 io_uring 写完后调用
-        ctx.handler = [this, handle](int res) {
-            auto &writeCtx = conn_->getWriteContext();
-
-            if (res > 0)
-            {
-                // 每次成功写入一部分数据，就从缓冲区中移除，并累加已写字节数
-                conn_->getOutputBuffer().retrieve(res);
-                totalWritten_ += res;
-            }
-
-            // 检查解除阻塞的条件：
-            // 1. 发生错误或连接断开 (res <= 0)
-            // 2. 缓冲区积压的数据已经被发送出去，剩余数据量降至低水位阈值以下
-            if (res <= 0 ||
-                conn_->getOutputBuffer().readableBytes() <= conn_->getBackpressureConfig().outputBufferLowWaterMark)
-            {
-                // 满足条件，准备唤醒协程
-                // 将最终的写入结果（累计写入量或错误码）存入上下文，供 await_resume 读取
-                writeCtx.result_ = (res <= 0 && totalWritten_ == 0) ? res : totalWritten_;
-
-                // 注意：绝对不能在这里执行 writeCtx.handler = nullptr;
-                // 因为当前代码正运行在这个 lambda 内部，清除 handler 会导致 lambda 自身被析构，引发未定义行为(UB)
-                // handler 的安全清除工作必须推迟到协程恢复后的 await_resume 中进行
-                handle.resume();
-            }
-            else
-            {
-                // 缓冲区数据量仍然高于低水位，继续向 io_uring 提交写请求，协程继续保持挂起状态
-                conn_->submitWriteRequest();
-            }
-        };
-
-        // 提交第一次写请求，启动 handler 循环
-        conn_->submitWriteRequest();
+        return false;
     }
-    else
+    if (corked_)
     {
-        // 正常模式（未触发背压）：将协程句柄保存到 IoContext 中
-        // 当 io_uring 写操作完成时，EventLoop 会直接调用 handle.resume() 唤醒协程
-        ctx.coro_handle = handle;
-        ctx.handler = nullptr;
+        // Cork 模式：数据已进入合并队列，只有触发 kBlock 背压时才需要挂起
+        return !(conn_->getBackpressureConfig().strategy == BackpressureStrategy::kBlock &&
+                 conn_->pendingOutputBytes() >= conn_->getBackpressureConfig().outputBufferHighWaterMark);
+    }
+    // 没有积压数据（如发送 0 字节）时无需等待
+    return conn_->pendingOutputBytes() == 0;
+}
 
-        if (inFd_ >= 0)
-        {
-            // Sendfile 零拷贝模式
-            conn_->incrementPendingSpecialWrite();
-            conn_->submitSendfileRequest(inFd_, offset_, count_);
-        }
-        else if (regBuf_ != nullptr)
+bool AsyncWriteAwaitable::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    if (isOutputWrite())
+    {
+        // 有序写队列：outputBuffer_ 中的数据按追加顺序写入，已写总字节数达到目标值时恢复协程
+        // 普通发送等待当前积压数据全部写完（其中包含本次追加的数据）；
+        // Cork 模式下触发 kBlock 背压时，只需等待积压量降至低水位
+        size_t pending = conn_->pendingOutputBytes();
+        waitBytes_ = pending;
+        if (corked_)
         {
-            // 固定缓冲区模式：使用已注册缓冲区发送数据
-            conn_->incrementPendingSpecialWrite();
-            conn_->submitWriteRequestWithRegBuffer(regBuf_, regBufLen_, regBufIdx_);
+            size_t lowWaterMark = conn_->getBackpressureConfig().outputBufferLowWaterMark;
+            waitBytes_ = pending > lowWaterMark ? pending - lowWaterMark : 0;
         }
-        else
+        uint64_t target = conn_->getBytesWritten() + waitBytes_;
+
+        // 先登记等待者再提交：写请求需要按所有等待者中最早的截止时间链接 LINK_TIMEOUT
+        conn_->waitOutputWritten(handle, target, &result_, deadline_);
+        // 没有写请求在途时立即提交，否则数据会在在途写请求完成后被合并提交；
+        // SQ 满时连接会在批处理结束时重试提交，等待者保持登记并照常挂起
+        conn_->flush();
+        if (!conn_->isOutputWritePending())
         {
-            // 普通模式：从 outputBuffer_ 发送数据
-            conn_->submitWriteRequest();
+            // 写请求无法提交（连接已断开），不挂起，直接在 await_resume 中返回 -ENOTCONN
+            conn_->removeOutputWaiter(&result_);
+            submitFailed_ = true;
+            return false;
         }
+        suspended_ = true;
+        return true;
     }
-}
 
-int AsyncWriteAwaitable::await_resume() const noexcept
-{
+    // 固定缓冲区/Sendfile/零拷贝模式：将协程句柄保存到 IoContext 中
+    // 当 io_uring 写操作完成时，EventLoop 会直接调用 handle.resume() 唤醒协程
     auto &ctx = conn_->getWriteContext();
-    // 读取实际写入的字节数（或错误码），在后续开发中业务层可根据此结果进行错误处理
-    int n = ctx.result_;
-
-    // 安全清除 handler：此时协程已经恢复，离开 lambda 作用域，可以安全地销毁 handler
+    ctx.coro_handle = handle;
     ctx.handler = nullptr;
 
     if (inFd_ >= 0)
     {
         // Sendfile 零拷贝模式
-        conn_->decrementPendingSpecialWrite();
+        conn_->incrementPendingSpecialWrite();
+        conn_->submitSendfileRequest(inFd_, offset_, count_);
     }
-    else if (regBuf_ != nullptr)
+    else
     {
-        // 固定缓冲区模式
-        conn_->decrementPendingSpecialWrite();
+        // 固定缓冲区模式：使用已注册缓冲区发送数据
+        conn_->incrementPendingSpecialWrite();
+        conn_->submitWriteRequestWithRegBuffer(regBuf_, regBufLen_, regBufIdx_);
     }
-    else if (!isBlocked_ && n > 0)
+    return true;
+}
+
+int AsyncWriteAwaitable::await_resume() const noexcept
+{
+    if (isOutputWrite())
     {
-        // 正常模式
-        conn_->getOutputBuffer().retrieve(n);
+        if (submitFailed_)
+        {
+            // 数据已追加到 outputBuffer_，随连接关闭一起丢弃；不返回 -EAGAIN，避免调用方重试导致重复发送
+            return -ENOTCONN;
+        }
+        if (suspended_ && result_ <= 0)
+        {
+            // 写失败：返回错误码（数据仍留在缓冲区中，由连接关闭流程统一回收）
+            return result_;
+        }
+        // 成功：asyncSend 返回本次发送的字节数，asyncWrite 返回等待期间写完的字节数
+        return isSend_ ? static_cast<int>(sendBytes_) : static_cast<int>(waitBytes_);
     }
 
+    auto &ctx = conn_->getWriteContext();
+    // 读取实际写入的字节数（或错误码），在后续开发中业务层可根据此结果进行错误处理
+    int n = ctx.result_;
+
+    // 固定缓冲区/Sendfile 模式
+    conn_->decrementPendingSpecialWrite();
+
     // 每次实际的写操作完成后，检查连接是否处于 kDisconnecting 断开中状态。
     // 如果是，并且 outputBuffer_ 已经被清空，说明收尾工作执行完毕，真正调用物理 shutdown
     conn_->maybeShutdownWrite();
 
     return n;
-}
\ No newline at end of file
+}
@@ -50,4 +50,11 @@ void Buffer::append(const char *data, size_t len)
 void Buffer::append(const std::string &str)
 {
     append(str.data(), str.size());
+}
+
+void Buffer::swap(Buffer &rhs)
+{
+    buffer_.swap(rhs.buffer_);
+    std::swap(readIndex_, rhs.readIndex_);
+    std::swap(writeIndex_, rhs.writeIndex_);
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "ComputePool.hpp"
+
+#include "Logger.hpp"
+
+ComputePool::ComputePool(size_t numThreads, size_t queueCapacity) : numThreads_(numThreads), queue_(queueCapacity)
+{
+}
+
+ComputePool::~ComputePool()
+{
+    stop();
+}
+
+void ComputePool::start()
+{
+    if (running_.exchange(true))
+    {
+        return;
+    }
+    threads_.reserve(numThreads_);
+    for (size_t i = 0; i < numThreads_; ++i)
+    {
+        threads_.emplace_back(&ComputePool::workerLoop, this);
+    }
+    LOG_INFO("ComputePool started with {} threads", numThreads_);
+}
+
+void ComputePool::stop()
+{
+    if (!running_.exchange(false))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cond_.notify_all();
+    }
+    for (std::thread &t : threads_)
+    {
+        t.join();
+    }
+    threads_.clear();
+    // 等待已通过 running_ 检查的 post 完成入队，之后不会再有新的入队
+    while (posting_.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+    // 与 stop 并发、在线程退出后才入队的协程片段，在调用线程上执行完，避免协程被丢弃
+    std::coroutine_handle<> handle;
+    while (queue_.dequeue(handle))
+    {
+        handle.resume();
+    }
+}
+
+bool ComputePool::post(std::coroutine_handle<> handle)
+{
+    // 先登记再检查 running_，与 stop 中"先清 running_、再等 posting_ 归零"配对（均为 seq_cst）：
+    // 要么这里看到已停止而拒绝，要么 stop 等到本次入队完成后才做最后的清空
+    posting_.fetch_add(1);
+    if (!running_.load() || !queue_.enqueue(handle))
+    {
+        posting_.fetch_sub(1, std::memory_order_release);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // 与 workerLoop 中"先登记空闲、再检查队列"配对：入队之后再读空闲数，不会漏掉正要睡眠的线程
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (idleWorkers_.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cond_.notify_one();
+    }
+    posting_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+ComputePool::Stats ComputePool::getStats() const
+{
+    Stats stats;
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ComputePool::workerLoop()
+{
+    std::coroutine_handle<> handle;
+    while (true)
+    {
+        if (queue_.dequeue(handle))
+        {
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            handle.resume();
+            continue;
+        }
+        if (!running_.load(std::memory_order_acquire))
+        {
+            // 已停止且队列已取空
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleWorkers_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cond_.wait(lock, [this] { return !queue_.empty() || !running_.load(std::memory_order_acquire); });
+        idleWorkers_.fetch_sub(1);
+    }
+}
@@ -0,0 +1,98 @@
+#include "Connector.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "EventLoop.hpp"
+#include "Logger.hpp"
+#include "TcpConnection.hpp"
+#include "TcpConnectionPool.hpp"
+
+namespace
+{
+std::atomic<uint64_t> g_nextClientConnId{1}; // 客户端连接 ID，各 Loop 共用
+
+std::string makeClientConnName(const InetAddress &addr)
+{
+    // 连接名称格式为：Client-对端IP:端口#连接ID，例如 Client-10.0.0.2:9000#1
+    std::string ipPort = addr.toIpPort();
+    char idBuf[24];
+    auto idEnd = std::to_chars(idBuf, idBuf + sizeof idBuf, g_nextClientConnId.fetch_add(1)).ptr;
+    std::string name;
+    name.reserve(8 + ipPort.size() + (idEnd - idBuf));
+    name.append("Client-").append(ipPort).append("#").append(idBuf, idEnd);
+    return name;
+}
+} // namespace
+
+bool ConnectAwaitable::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd_ < 0)
+    {
+        connectContext_.result_ = -errno;
+        LOG_ERROR("ConnectAwaitable socket create failed: {}", std::strerror(errno));
+        return false;
+    }
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&loop_->ring_);
+    if (!sqe)
+    {
+        connectContext_.result_ = -EBUSY;
+        LOG_ERROR("ConnectAwaitable: SQ full, addr={}", addr_.toIpPort());
+        return false;
+    }
+    connectContext_.fd = fd_;
+    connectContext_.coro_handle = handle;
+    io_uring_prep_connect(sqe, fd_, reinterpret_cast<const struct sockaddr *>(&addr_.getSockAddrIn()),
+                          sizeof(struct sockaddr_in));
+    io_uring_sqe_set_data(sqe, &connectContext_);
+    if (deadline_ != kNoDeadline)
+    {
+        // 超时 SQE 的 CQE 不需要处理，user_data 置空
+        if (struct io_uring_sqe *timeoutSqe = loop_->linkDeadline(sqe, deadline_, &deadlineSpec_))
+        {
+            io_uring_sqe_set_data(timeoutSqe, nullptr);
+        }
+    }
+    return true;
+}
+
+ConnectResult ConnectAwaitable::await_resume()
+{
+    int res = connectContext_.result_;
+    if (res == -ECANCELED && deadlineExpired(deadline_))
+    {
+        // 链接的 LINK_TIMEOUT 到期取消了 connect，与主动取消区分开
+        res = kDeadlineExceeded;
+    }
+    if (res < 0)
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        LOG_WARN("ConnectAwaitable connect failed, addr={}, res={}", addr_.toIpPort(), res);
+        return ConnectResult{nullptr, res};
+    }
+
+    // 与 accept 的连接共用所属 Loop 的对象池
+    auto conn = loop_->getConnectionPool().acquire(makeClientConnName(addr_), fd_, addr_);
+    fd_ = -1;
+    // 客户端连接不属于任何 TcpServer，关闭时直接在所属 Loop 销毁
+    conn->setCloseCallback([](const std::shared_ptr<TcpConnection> &c) {
+        c->getLoop()->queueInLoop(std::bind(&TcpConnection::connectDestroyed, c));
+    });
+    conn->connectEstablished();
+    return ConnectResult{std::move(conn), 0};
+}
+
+void ConnectAwaitable::cancel() noexcept
+{
+    loop_->cancelIo(&connectContext_);
+}
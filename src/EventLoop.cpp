@@ -7,9 +7,13 @@
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
 #include <thread>
 
+#include "IdleTimingWheel.hpp"
 #include "Logger.hpp"
+#include "TcpConnectionPool.hpp"
+#include "TimerQueue.hpp"
 
 // 获取当前线程ID的辅助函数 (Linux specific)
 // #include <sys/syscall.h>
@@ -20,6 +24,9 @@
 
 namespace
 {
+// 每个线程最多运行一个 EventLoop
+thread_local EventLoop *t_loopInThisThread = nullptr;
+
 // 把 EventLoop::Options 里的关键字段做“兜底修正”，避免用户传入 0 或非法值导致运行异常。
 EventLoop::Options normalizeOptions(EventLoop::Options options)
 {
@@ -39,6 +46,22 @@ EventLoop::Options normalizeOptions(EventLoop::Options options)
     {
         options.registeredBuffersSize = 4096;
     }
+    if (options.idleWheelTick <= std::chrono::milliseconds::zero())
+    {
+        options.idleWheelTick = std::chrono::milliseconds(1000);
+    }
+    if (options.idleWheelSlots == 0)
+    {
+        options.idleWheelSlots = 64;
+    }
+    if (options.timerTick <= std::chrono::milliseconds::zero())
+    {
+        options.timerTick = std::chrono::milliseconds(1);
+    }
+    if (options.timerSlack < std::chrono::milliseconds::zero())
+    {
+        options.timerSlack = std::chrono::milliseconds::zero();
+    }
     // 修正背压水位标记
     if (options.pendingQueueHighWaterMark == 0 || options.pendingQueueHighWaterMark > options.pendingQueueCapacity)
     {
@@ -59,7 +82,8 @@ EventLoop::EventLoop() : EventLoop(Options())
 EventLoop::EventLoop(const Options &options)
     : options_(normalizeOptions(options)), running_(false), quit_(false), threadId_(::gettid()),
       wakeupFd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), wakeupContext_(IoType::Read, wakeupFd_),
-      callingPendingFunctors_(false), pendingFunctors_{options_.pendingQueueCapacity}
+      callingPendingFunctors_(false), pendingFunctors_{options_.pendingQueueCapacity}, clock_(options_.coarseClock),
+      connectionPool_(std::make_shared<TcpConnectionPool>(this, options_.connectionPoolCapacity))
 {
     if (wakeupFd_ < 0)
     {
@@ -67,6 +91,16 @@ EventLoop::EventLoop(const Options &options)
         abort();
     }
 
+    // EventLoop 在其所属线程中构造，此后该线程创建的协程帧都从本 Loop 的帧池分配
+    framePool_.attachToCurrentThread();
+    arenaChunkPool_.attachToCurrentThread();
+    clock_.attachToCurrentThread();
+    if (t_loopInThisThread)
+    {
+        LOG_WARN("Another EventLoop already exists in this thread, loop={}", static_cast<void *>(t_loopInThisThread));
+    }
+    t_loopInThisThread = this;
+
     // 初始化 io_uring，队列深度设为 4096
     // 开启 IORING_SETUP_SQPOLL 以消除 io_uring_submit 的系统调用开销
     // 这会启动一个内核线程来轮询 SQ Ring，极大提升高频小包场景的吞吐量
@@ -95,6 +129,16 @@ EventLoop::EventLoop(const Options &options)
 
 EventLoop::~EventLoop()
 {
+    // 之后才释放的连接对象直接析构，不再访问本 Loop
+    connectionPool_->detach();
+    framePool_.detachFromCurrentThread();
+    arenaChunkPool_.detachFromCurrentThread();
+    clock_.detachFromCurrentThread();
+    if (t_loopInThisThread == this)
+    {
+        t_loopInThisThread = nullptr;
+    }
+
     if (!registeredIovecs.empty())
     {
         int ret = io_uring_unregister_buffers(&ring_);
@@ -123,6 +167,9 @@ void EventLoop::loop()
 
     while (!quit_)
     {
+        // 定时器最先写入 SQ：上一轮批处理中暂存的 timeout 与普通 IO 一起提交，不额外触发系统调用
+        flushStagedTimeouts();
+
         // 仅在有待提交 SQE 时提交，减少无效系统调用
         // 必须在等待之前提交，否则内核不知道有新请求，可能死锁
         if (io_uring_sq_ready(&ring_) > 0)
@@ -133,6 +180,8 @@ void EventLoop::loop()
         struct io_uring_cqe *cqe;
         // 等待至少一个事件完成
         int ret = io_uring_wait_cqe(&ring_, &cqe);
+        // 每轮只读一次时钟，本轮的事件处理、日志、定时器都使用这次的快照
+        clock_.update();
 
         if (ret < 0)
         {
@@ -158,11 +207,102 @@ void EventLoop::loop()
 
         // 执行任务队列中的任务
         doPendingFunctors();
+
+        // 批处理收尾：如 Cork 模式下合并本轮所有 asyncSend 为一次写请求
+        doBatchEndFunctors();
     }
 
     running_ = false;
 }
 
+EventLoop *EventLoop::current()
+{
+    return t_loopInThisThread;
+}
+
+void EventLoop::cancelIo(IoContext *ctx)
+{
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+    if (!sqe)
+    {
+        LOG_ERROR("EventLoop::cancelIo: SQ full");
+        return;
+    }
+    io_uring_prep_cancel(sqe, ctx, IORING_ASYNC_CANCEL_ALL);
+    io_uring_sqe_set_data(sqe, nullptr);
+}
+
+struct io_uring_sqe *EventLoop::linkDeadline(struct io_uring_sqe *sqe, Deadline deadline, __kernel_timespec *spec)
+{
+    // 先确认超时 SQE 可用再设置链接标志，否则链接会延伸到下一个无关的 SQE
+    if (io_uring_sq_space_left(&ring_) < 1)
+    {
+        LOG_ERROR("EventLoop::linkDeadline: SQ full");
+        return nullptr;
+    }
+    // steady_clock 即 CLOCK_MONOTONIC，时间点可以直接作为绝对超时使用
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    spec->tv_sec = ns / 1000000000;
+    spec->tv_nsec = ns % 1000000000;
+    sqe->flags |= IOSQE_IO_LINK;
+    struct io_uring_sqe *timeoutSqe = io_uring_get_sqe(&ring_);
+    io_uring_prep_link_timeout(timeoutSqe, spec, IORING_TIMEOUT_ABS);
+    return timeoutSqe;
+}
+
+void EventLoop::stageTimeout(IoContext *ctx, __kernel_timespec *spec)
+{
+    stagedTimeouts_.push_back(StagedTimeout{ctx, spec});
+}
+
+bool EventLoop::unstageTimeout(IoContext *ctx)
+{
+    auto it = std::find_if(stagedTimeouts_.begin(), stagedTimeouts_.end(),
+                           [ctx](const StagedTimeout &staged) { return staged.ctx == ctx; });
+    if (it == stagedTimeouts_.end())
+    {
+        return false;
+    }
+    stagedTimeouts_.erase(it);
+    return true;
+}
+
+Deadline EventLoop::applyTimerSlack(Deadline deadline) const
+{
+    int64_t slack = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.timerSlack).count();
+    if (slack <= 0 || deadline == kNoDeadline)
+    {
+        return deadline;
+    }
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    ns = (ns + slack - 1) / slack * slack;
+    return Deadline(std::chrono::duration_cast<Deadline::duration>(std::chrono::nanoseconds(ns)));
+}
+
+void EventLoop::flushStagedTimeouts()
+{
+    size_t i = 0;
+    for (; i < stagedTimeouts_.size(); ++i)
+    {
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+        if (!sqe)
+        {
+            // SQ 满：先把已有的请求提交出去腾出空间
+            io_uring_submit(&ring_);
+            sqe = io_uring_get_sqe(&ring_);
+        }
+        if (!sqe)
+        {
+            // 剩余的留到下一轮
+            LOG_ERROR("EventLoop::flushStagedTimeouts: SQ full, {} timeouts deferred", stagedTimeouts_.size() - i);
+            break;
+        }
+        io_uring_prep_timeout(sqe, stagedTimeouts_[i].spec, 0, IORING_TIMEOUT_ABS);
+        io_uring_sqe_set_data(sqe, stagedTimeouts_[i].ctx);
+    }
+    stagedTimeouts_.erase(stagedTimeouts_.begin(), stagedTimeouts_.begin() + static_cast<std::ptrdiff_t>(i));
+}
+
 void EventLoop::quit()
 {
     quit_ = true;
@@ -184,9 +324,21 @@ void EventLoop::runInLoop(Functor cb)
     }
 }
 
+void EventLoop::runAfterBatch(Functor cb)
+{
+    // 单线程无锁操作
+    batchEndFunctors_.emplace_back(std::move(cb));
+}
+
 // 将任务放入跨线程任务队列（pendingFunctors_）中，并唤醒目标 EventLoop 线程执行
 // 包含队列级别的背压机制：防止主线程分发任务过快，导致工作线程队列积压 OOM
-void EventLoop::queueInLoop(Functor cb)
+bool EventLoop::queueInLoop(Functor cb)
+{
+    return tryQueueInLoop(cb);
+}
+
+// 入队失败时 cb 保持原样，供 queueInLoopOrOverflow 转入溢出链表
+bool EventLoop::tryQueueInLoop(Functor &cb)
 {
     // 获取当前队列大小（无锁队列的 size() 是近似值，但用于背压判断足够了）
     size_t curQueueSize = pendingFunctors_.size();
@@ -201,7 +353,7 @@ void EventLoop::queueInLoop(Functor cb)
             LOG_ERROR("EventLoop: pending queue full! queueSize={}, capacity={}, droppedCount={}", curQueueSize,
                       options_.pendingQueueCapacity, backpressureStats_.queueFullCount);
         }
-        return;
+        return false;
     }
 
     // 统计：记录队列达到的最大峰值，便于后续调优
@@ -239,10 +391,45 @@ void EventLoop::queueInLoop(Functor cb)
     }
 
     // 如果不在当前线程，或者当前正在执行 pendingFunctors，都需要唤醒
+    // 与 doPendingFunctors 开头清除标志配对：入队之后再检查标志，Loop 清除标志之后必然能取到本次入队的任务
     if (::gettid() != threadId_ || callingPendingFunctors_)
     {
-        wakeup();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!wakeupPending_.exchange(true))
+        {
+            wakeup();
+        }
     }
+    return true;
+}
+
+void EventLoop::queueInLoopOrOverflow(Functor cb)
+{
+    if (tryQueueInLoop(cb))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        overflowFunctors_.push_back(std::move(cb));
+        hasOverflow_.store(true, std::memory_order_release);
+    }
+    // 与 queueInLoop 相同的合并唤醒
+    if (::gettid() != threadId_ || callingPendingFunctors_)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!wakeupPending_.exchange(true))
+        {
+            wakeup();
+        }
+    }
+}
+
+void EventLoop::ScheduleAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    // 只捕获协程句柄，std::function 走小对象优化，不产生堆分配
+    // 协程不能在错误的线程上继续执行，也不能被丢弃：目标 Loop 队列已满时转入溢出链表，不在调用线程上忙等
+    loop_->queueInLoopOrOverflow([handle]() { handle.resume(); });
 }
 
 void EventLoop::handleCompletionEvent(io_uring_cqe *cqe)
@@ -253,6 +440,12 @@ void EventLoop::handleCompletionEvent(io_uring_cqe *cqe)
         return;
     }
     IoContext *ctx = static_cast<IoContext *>(data);
+    // 最终 CQE（多 CQE 请求的最后一个）到达，请求不再引用该上下文；必须在下面的存活检查之前计数，
+    // 否则连接对象进入对象池等待区后，被忽略的 CQE 永远不会被计入
+    if (ctx->inflight > 0 && !(cqe->flags & IORING_CQE_F_MORE))
+    {
+        --ctx->inflight;
+    }
 
     // Cancel CQE 安全检查：如果 IoContext 绑定了 TcpConnection，检查连接是否还活着
     // 只有 TcpConnection 的读写 IO 才绑定了 connection（Acceptor/Wakeup 的 connection 为空）
@@ -346,6 +539,26 @@ void *EventLoop::getRegisteredBuffer(int idx)
     return registeredBuffersPool[idx];
 }
 
+IdleTimingWheel &EventLoop::getIdleTimingWheel()
+{
+    // 单线程访问，懒创建即可；没有连接使用时间轮的 Loop 不会产生任何 tick
+    if (!idleTimingWheel_)
+    {
+        idleTimingWheel_ = std::make_unique<IdleTimingWheel>(this, options_.idleWheelTick, options_.idleWheelSlots);
+    }
+    return *idleTimingWheel_;
+}
+
+TimerQueue &EventLoop::getTimerQueue()
+{
+    // 与时间轮相同：懒创建，没有定时器的 Loop 不占用 timeout
+    if (!timerQueue_)
+    {
+        timerQueue_ = std::make_unique<TimerQueue>(this, options_.timerTick);
+    }
+    return *timerQueue_;
+}
+
 void EventLoop::handleWakeup()
 {
     // 重新提交 wakeup 读请求，以便下一次唤醒
@@ -372,19 +585,41 @@ void EventLoop::asyncReadWakeup()
 void EventLoop::doPendingFunctors()
 {
     callingPendingFunctors_ = true;
+    // 先清除唤醒标志再取任务：此后的跨线程投递会重新写 eventfd
+    wakeupPending_.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 
-    // 批量出队到本地
+    // 批量出队到本地：单消费者队列一次扫描取走已写完的连续一段，整批只推进一次出队位置
+    // 为了防止饿死IO，单轮设一个较大的上限 (65536)
+    constexpr size_t kMaxBatch = 65536;
     std::vector<Functor> functors;
-    // 预留足够空间，避免频繁分配
-    functors.reserve(4096);
+    functors.reserve(std::min(pendingFunctors_.size(), kMaxBatch));
+    size_t taken = 0;
+    while (taken < kMaxBatch)
+    {
+        size_t n = pendingFunctors_.dequeueBulk(std::back_inserter(functors), kMaxBatch - taken);
+        if (n == 0)
+        {
+            break;
+        }
+        taken += n;
+    }
+    if (taken == kMaxBatch && !pendingFunctors_.empty() && !wakeupPending_.exchange(true))
+    {
+        // 单轮上限内没有取完：剩余任务的投递方可能因标志已置位而没有唤醒，这里补一次
+        wakeup();
+    }
 
-    Functor f;
-    // 关键修复：移除大小限制，尽可能排空队列，防止积压
-    // 为了防止饿死IO，可以设一个较大的上限 (如 65536)
-    int limit = 65536;
-    while (limit-- > 0 && pendingFunctors_.dequeue(f))
+    // 队列满时转入的溢出任务，很少出现，先读标志避免每轮加锁
+    if (hasOverflow_.load(std::memory_order_acquire))
     {
-        functors.emplace_back(std::move(f));
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        hasOverflow_.store(false, std::memory_order_relaxed);
+        for (auto &func : overflowFunctors_)
+        {
+            functors.push_back(std::move(func));
+        }
+        overflowFunctors_.clear();
     }
 
     // 无锁执行（此时生产者仍可入队到剩余队列）
@@ -396,6 +631,21 @@ void EventLoop::doPendingFunctors()
     callingPendingFunctors_ = false;
 }
 
+void EventLoop::doBatchEndFunctors()
+{
+    if (batchEndFunctors_.empty())
+    {
+        return;
+    }
+    // 先交换出来再执行，回调中再次登记的任务留到下一轮批处理
+    runningBatchEndFunctors_.swap(batchEndFunctors_);
+    for (auto &func : runningBatchEndFunctors_)
+    {
+        func();
+    }
+    runningBatchEndFunctors_.clear();
+}
+
 EventLoop::BackpressureStats EventLoop::getBackpressureStats() const
 {
     return backpressureStats_;
@@ -0,0 +1,120 @@
+#include "IdleTimingWheel.hpp"
+
+#include <cerrno>
+
+#include "EventLoop.hpp"
+#include "Logger.hpp"
+#include "TcpConnection.hpp"
+
+IdleTimingWheel::IdleTimingWheel(EventLoop *loop, std::chrono::milliseconds tick, size_t slots)
+    : loop_(loop), tick_(tick), tickSpec_(), tickContext_(IoType::Timeout, -1), slots_(slots == 0 ? 1 : slots)
+{
+    if (tick_ <= std::chrono::milliseconds::zero())
+    {
+        tick_ = std::chrono::milliseconds(1000);
+    }
+    tickSpec_.tv_sec = tick_.count() / 1000;
+    tickSpec_.tv_nsec = (tick_.count() % 1000) * 1000000;
+    // 时间轮由 EventLoop 持有，生命周期覆盖所有在途的 tick，捕获 this 即可
+    tickContext_.handler = [this](int res) { handleTick(res); };
+}
+
+void IdleTimingWheel::add(const std::shared_ptr<TcpConnection> &conn, std::chrono::milliseconds timeout)
+{
+    uint64_t timeoutTicks = static_cast<uint64_t>((timeout.count() + tick_.count() - 1) / tick_.count());
+    if (timeoutTicks == 0)
+    {
+        timeoutTicks = 1;
+    }
+    schedule(Entry{conn, timeoutTicks}, currentTick_ + timeoutTicks);
+    if (!armed_)
+    {
+        armTick();
+    }
+}
+
+void IdleTimingWheel::schedule(Entry &&entry, uint64_t deadline)
+{
+    slots_[deadline % slots_.size()].push_back(std::move(entry));
+    ++size_;
+}
+
+void IdleTimingWheel::armTick()
+{
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&loop_->ring_);
+    if (!sqe)
+    {
+        // SQ 满：先把已有的请求提交出去腾出空间
+        io_uring_submit(&loop_->ring_);
+        sqe = io_uring_get_sqe(&loop_->ring_);
+    }
+    if (!sqe)
+    {
+        // 仍然没有空间：下一轮批处理结束时重试。不能等下一次 add，服务停止接收新连接（如排空）时不会再有 add，
+        // 轮中的空闲连接将永远不被回收；主动唤醒一次 Loop，保证下一轮循环一定会到来
+        LOG_ERROR("IdleTimingWheel::armTick: SQ full, retry after batch");
+        loop_->runAfterBatch([this]() {
+            if (!armed_ && size_ > 0)
+            {
+                armTick();
+            }
+        });
+        loop_->wakeup();
+        return;
+    }
+    io_uring_prep_timeout(sqe, &tickSpec_, 0, 0);
+    io_uring_sqe_set_data(sqe, &tickContext_);
+    armed_ = true;
+}
+
+void IdleTimingWheel::handleTick(int res)
+{
+    armed_ = false;
+    if (res != -ETIME && res < 0)
+    {
+        // 被取消（如 io_uring 退出）时不再继续 tick
+        LOG_WARN("IdleTimingWheel::handleTick: timeout failed, res={}", res);
+        return;
+    }
+
+    ++currentTick_;
+    ++stats_.ticks;
+
+    // 先把当前槽位整体换出再处理，挂回的条目即使落在同一槽位也要等下一圈才会被扫描
+    scanning_.clear();
+    scanning_.swap(slots_[currentTick_ % slots_.size()]);
+    size_ -= scanning_.size();
+
+    uint64_t expired = 0;
+    for (Entry &entry : scanning_)
+    {
+        std::shared_ptr<TcpConnection> conn = entry.conn.lock();
+        if (!conn || !conn->isConnected())
+        {
+            // 连接已销毁或正在关闭，直接移出时间轮
+            continue;
+        }
+        uint64_t deadline = conn->getLastActiveTick() + entry.timeoutTicks;
+        if (deadline > currentTick_)
+        {
+            ++stats_.reinsertions;
+            schedule(std::move(entry), deadline);
+            continue;
+        }
+        LOG_DEBUG("Connection {} idle timeout, forcing close", conn->getName());
+        conn->forceClose();
+        ++expired;
+    }
+    scanning_.clear();
+
+    if (expired > 0)
+    {
+        stats_.expiredConnections += expired;
+        LOG_INFO("IdleTimingWheel: closed {} idle connections at tick {}", expired, currentTick_);
+    }
+
+    if (size_ > 0)
+    {
+        armTick();
+    }
+}
@@ -0,0 +1,47 @@
+#include "LoopClock.hpp"
+
+namespace
+{
+std::chrono::nanoseconds readClock(clockid_t id)
+{
+    struct timespec ts;
+    ::clock_gettime(id, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+} // namespace
+
+thread_local LoopClock *LoopClock::current_ = nullptr;
+
+LoopClock::LoopClock(bool coarse)
+    : monotonicId_(coarse ? CLOCK_MONOTONIC_COARSE : CLOCK_MONOTONIC),
+      wallId_(coarse ? CLOCK_REALTIME_COARSE : CLOCK_REALTIME)
+{
+    update();
+}
+
+LoopClock::~LoopClock()
+{
+    detachFromCurrentThread();
+}
+
+void LoopClock::update() noexcept
+{
+    // steady_clock/system_clock 在 Linux 上分别即 CLOCK_MONOTONIC/CLOCK_REALTIME，COARSE 版本与之同一时间基准
+    monotonic_ = std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(readClock(monotonicId_)));
+    wall_ = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(readClock(wallId_)));
+}
+
+void LoopClock::attachToCurrentThread() noexcept
+{
+    current_ = this;
+}
+
+void LoopClock::detachFromCurrentThread() noexcept
+{
+    if (current_ == this)
+    {
+        current_ = nullptr;
+    }
+}
@@ -130,3 +130,9 @@ void Socket::reset()
 {
     closeFd();
 }
+
+void Socket::assign(int sockfd)
+{
+    closeFd();
+    sockfd_ = sockfd;
+}
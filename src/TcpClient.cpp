@@ -0,0 +1,134 @@
+#include "TcpClient.hpp"
+
+#include <cerrno>
+#include <sys/socket.h>
+
+#include "EventLoop.hpp"
+#include "Logger.hpp"
+#include "TcpConnection.hpp"
+
+TcpClient::TcpClient(EventLoop *loop) : TcpClient(loop, Options())
+{
+}
+
+TcpClient::TcpClient(EventLoop *loop, const Options &options) : loop_(loop), options_(options)
+{
+}
+
+TcpClient::~TcpClient()
+{
+    closeIdle();
+}
+
+Task<ConnectResult> TcpClient::acquire(InetAddress addr, Deadline deadline)
+{
+    auto it = idle_.find(addr.toIpPort());
+    if (it != idle_.end())
+    {
+        IdleList &list = it->second;
+        evictExpired(list, loop_->now());
+        // 从最近归还的一端取，失败的直接关闭，继续尝试下一个
+        while (!list.empty())
+        {
+            std::shared_ptr<TcpConnection> conn = std::move(list.back().conn);
+            list.pop_back();
+            if (isHealthy(*conn))
+            {
+                ++stats_.reused;
+                co_return ConnectResult{std::move(conn), 0};
+            }
+            LOG_INFO("TcpClient evict unhealthy idle connection, conn={}", conn->getName());
+            ++stats_.evicted;
+            conn->forceClose();
+        }
+    }
+
+    ConnectResult result = co_await asyncConnect(loop_, addr, deadline);
+    if (result)
+    {
+        ++stats_.connected;
+    }
+    else
+    {
+        ++stats_.connectFailed;
+    }
+    co_return result;
+}
+
+void TcpClient::release(std::shared_ptr<TcpConnection> conn, bool reusable)
+{
+    if (!conn)
+    {
+        return;
+    }
+    if (!reusable || options_.maxIdlePerHost == 0 || !conn->isConnected() || conn->hasInflightIo() ||
+        conn->pendingOutputBytes() > 0)
+    {
+        ++stats_.discarded;
+        conn->forceClose();
+        return;
+    }
+    // 空闲期间不占用已注册缓冲区
+    conn->releaseCurReadBuffer();
+
+    auto now = loop_->now();
+    IdleList &list = idle_[conn->getPeerAddr().toIpPort()];
+    evictExpired(list, now);
+    if (list.size() >= options_.maxIdlePerHost)
+    {
+        // 超出缓存上限：关闭最久未用的一个
+        ++stats_.discarded;
+        list.front().conn->forceClose();
+        list.erase(list.begin());
+    }
+    list.push_back(IdleConnection{std::move(conn), now});
+}
+
+void TcpClient::closeIdle()
+{
+    for (auto &pair : idle_)
+    {
+        for (IdleConnection &idle : pair.second)
+        {
+            idle.conn->forceClose();
+        }
+    }
+    idle_.clear();
+}
+
+TcpClient::Stats TcpClient::getStats() const
+{
+    Stats stats = stats_;
+    for (const auto &pair : idle_)
+    {
+        stats.idle += pair.second.size();
+    }
+    return stats;
+}
+
+bool TcpClient::isHealthy(const TcpConnection &conn)
+{
+    if (!conn.isConnected() || conn.hasInflightIo())
+    {
+        return false;
+    }
+    // 空闲连接上没有在途读请求，对端关闭（返回 0）或残留数据（返回 > 0）只能主动探测
+    char probe;
+    ssize_t n = ::recv(conn.getFd(), &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+void TcpClient::evictExpired(IdleList &list, std::chrono::steady_clock::time_point now)
+{
+    size_t expired = 0;
+    while (expired < list.size() && now - list[expired].since >= options_.maxIdleTime)
+    {
+        list[expired].conn->forceClose();
+        ++expired;
+    }
+    if (expired > 0)
+    {
+        stats_.evicted += expired;
+        list.erase(list.begin(), list.begin() + static_cast<std::ptrdiff_t>(expired));
+    }
+}
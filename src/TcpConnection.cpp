@@ -1,14 +1,19 @@
 #include "TcpConnection.hpp"
 
+#include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
 
 TcpConnection::TcpConnection(const std::string &name, EventLoop *loop, int sockfd, const InetAddress &peerAddr)
     : name_(name), loop_(loop), socket_(sockfd), state_(TcpConnectionState::kConnecting), reading_(false),
       curReadBuffer_(nullptr), curReadBufferSize_(0), curReadBufferOffset_(0), outputBuffer_(),
+      outputContext_(IoType::Write, sockfd), relayInContext_(IoType::Read, sockfd),
+      relayOutContext_(IoType::Write, sockfd),
       readContext_(IoType::Read, sockfd), writeContext_(IoType::Write, sockfd),
       timeoutContext_(IoType::Timeout, sockfd), readTimeout_(0), readTimeoutSpec_(),
+      readDeadlineContext_(IoType::Timeout, sockfd), outputDeadlineContext_(IoType::Timeout, sockfd),
       localAddr_(socket_.getLocalAddress()), peerAddr_(peerAddr), connectionCallback_(nullptr), closeCallback_(nullptr)
 {
     // 协程模式下，不需要绑定传统的回调函数 (handleRead/handleWrite)
@@ -16,6 +21,7 @@ TcpConnection::TcpConnection(const std::string &name, EventLoop *loop, int sockf
 
 TcpConnection::~TcpConnection()
 {
+    closeRelayPipe();
     // 逻辑关闭连接，调用socket的析构函数释放资源
 }
 
@@ -44,9 +50,84 @@ void TcpConnection::reset()
     curReadBufferOffset_ = 0;
     writeContext_.coro_handle = nullptr;
     writeContext_.result_ = 0;
+    // 写队列与 Cork 状态
+    flushingBuffer_.reset();
+    outputWriteInFlight_ = false;
+    bytesWritten_ = 0;
+    outputWaiters_.clear();
+    outputWriteDeadline_ = kNoDeadline;
+    flushScheduled_ = false;
+    // 链接式中继状态
+    if (relayInContext_.idx >= 0)
+    {
+        loop_->returnRegisteredBuffer(relayInContext_.idx);
+    }
+    relayInContext_.idx = -1;
+    relayHandle_ = nullptr;
+    relayInFlight_ = false;
+    relayPending_ = 0;
+    relayDstFd_ = -1;
+    closeRelayPipe();
+    idleTimeout_ = std::chrono::milliseconds(0);
+    idleTimingWheel_ = nullptr;
+    lastActiveTick_ = 0;
+    // 释放上一个连接的弱引用与回调，避免复用后的 CQE 检查、关闭流程误用旧连接的状态
+    for (IoContext *ctx : {&readContext_, &writeContext_, &timeoutContext_, &outputContext_, &relayInContext_,
+                           &relayOutContext_, &readDeadlineContext_, &outputDeadlineContext_})
+    {
+        ctx->connection.reset();
+        ctx->handler = nullptr;
+        ctx->coro_handle = nullptr;
+    }
+    pendingSpecialWriteCount_.store(0);
+    readTimeout_ = std::chrono::milliseconds(0);
+    inHighWaterMark_.store(false);
+    outputBufferStats_ = OutputBufferStats();
+    backpressureConfig_ = BackpressureConfig();
+    corking_ = false;
+    draining_.store(false);
+    awaitingRequest_ = false;
+    drainAborted_ = false;
+    connectionCallback_ = nullptr;
+    closeCallback_ = nullptr;
     loop_ = nullptr;
 }
 
+void TcpConnection::reinit(const std::string &name, EventLoop *loop, int sockfd, const InetAddress &peerAddr)
+{
+    name_ = name;
+    loop_ = loop;
+    socket_.assign(sockfd);
+    state_.store(TcpConnectionState::kConnecting);
+    for (IoContext *ctx : {&readContext_, &writeContext_, &timeoutContext_, &outputContext_, &relayInContext_,
+                           &relayOutContext_, &readDeadlineContext_, &outputDeadlineContext_})
+    {
+        ctx->fd = sockfd;
+    }
+    localAddr_ = socket_.getLocalAddress();
+    peerAddr_ = peerAddr;
+}
+
+bool TcpConnection::hasInflightIo() const
+{
+    return readContext_.inflight > 0 || writeContext_.inflight > 0 || timeoutContext_.inflight > 0 ||
+           outputContext_.inflight > 0 || relayInContext_.inflight > 0 || relayOutContext_.inflight > 0 ||
+           readDeadlineContext_.inflight > 0 || outputDeadlineContext_.inflight > 0;
+}
+
+void TcpConnection::cancelInflightIo()
+{
+    // fd 在 connectDestroyed 中已经关闭（且 fd 号可能已被新连接复用），只能按 user_data 取消
+    for (IoContext *ctx : {&readContext_, &writeContext_, &timeoutContext_, &outputContext_, &relayInContext_,
+                           &relayOutContext_, &readDeadlineContext_, &outputDeadlineContext_})
+    {
+        if (ctx->inflight > 0)
+        {
+            loop_->cancelIo(ctx);
+        }
+    }
+}
+
 void TcpConnection::shutdown()
 {
     // 发送FIN包，尝试半关闭写端
@@ -54,7 +135,7 @@ void TcpConnection::shutdown()
     {
         setState(TcpConnectionState::kDisconnecting);
         // 仅当用户缓冲区没有积压数据，且没有挂起的特殊写操作(固定缓冲/ZC)时，才立刻物理关闭
-        if (outputBuffer_.readableBytes() == 0 && !hasPendingSpecialWrite())
+        if (pendingOutputBytes() == 0 && !hasPendingSpecialWrite())
         {
             socket_.shutdownWrite();
         }
@@ -64,7 +145,7 @@ void TcpConnection::shutdown()
 void TcpConnection::maybeShutdownWrite()
 {
     // 这个方法通常由底层写回调(如 AsyncWrite 恢复时)调用
-    if (state_.load() == TcpConnectionState::kDisconnecting && outputBuffer_.readableBytes() == 0 &&
+    if (state_.load() == TcpConnectionState::kDisconnecting && pendingOutputBytes() == 0 &&
         !hasPendingSpecialWrite())
     {
         socket_.shutdownWrite();
@@ -85,7 +166,7 @@ void TcpConnection::forceClose()
     }
 }
 
-void TcpConnection::submitReadRequest(size_t nbytes)
+void TcpConnection::submitReadRequest(size_t nbytes, Deadline deadline)
 {
     if (!isConnected())
     {
@@ -108,7 +189,7 @@ void TcpConnection::submitReadRequest(size_t nbytes)
         // 把已注册缓冲区的索引存到 IoContext 的 idx 字段，以便完成后归还
         readContext_.idx = idx;
         io_uring_prep_read_fixed(sqe, socket_.getFd(), buf, nbytes, 0, idx);
-        io_uring_sqe_set_data(sqe, &readContext_);
+        bindSqe(sqe, readContext_);
     }
     else
     {
@@ -116,23 +197,11 @@ void TcpConnection::submitReadRequest(size_t nbytes)
         LOG_ERROR("TcpConnection::submitReadRequest: no registered buffer available");
     }
 
-    if (readTimeout_ > std::chrono::milliseconds::zero())
-    {
-        io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
-        io_uring_sqe *ts_sqe = io_uring_get_sqe(&loop_->ring_);
-        if (ts_sqe)
-        {
-            io_uring_prep_link_timeout(ts_sqe, &readTimeoutSpec_, 0);
-            io_uring_sqe_set_data(ts_sqe, &timeoutContext_);
-        }
-        else
-        {
-            LOG_ERROR("TcpConnection::submitReadRequest: link timeout sqe unavailable");
-        }
-    }
+    linkReadTimeout(sqe, deadline);
 }
 
-void TcpConnection::submitReadRequestWithUserBuffer(char *userBuf, size_t userBufCap, size_t nbytes)
+void TcpConnection::submitReadRequestWithUserBuffer(char *userBuf, size_t userBufCap, size_t nbytes,
+                                                    Deadline deadline)
 {
     if (!isConnected())
     {
@@ -155,22 +224,39 @@ void TcpConnection::submitReadRequestWithUserBuffer(char *userBuf, size_t userBu
     }
     // 使用用户提供的缓冲区进行读操作
     io_uring_prep_read(sqe, socket_.getFd(), userBuf, std::min(userBufCap, nbytes), 0);
-    io_uring_sqe_set_data(sqe, &readContext_);
+    bindSqe(sqe, readContext_);
     // 标记 idx 为 -1，表示未使用已注册缓冲区
     readContext_.idx = -1;
 
-    if (readTimeout_ > std::chrono::milliseconds::zero())
+    linkReadTimeout(sqe, deadline);
+}
+
+void TcpConnection::linkReadTimeout(struct io_uring_sqe *sqe, Deadline deadline)
+{
+    // 一个请求只能链接一个 LINK_TIMEOUT：连接级读超时到期会关闭连接，本次读的截止时间到期只让这次读返回，
+    // 两者同时设置时取先到期的一个
+    bool useReadTimeout = readTimeout_ > std::chrono::milliseconds::zero() &&
+                          (deadline == kNoDeadline || deadlineAfter(readTimeout_) < deadline);
+    if (useReadTimeout)
     {
         io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
         io_uring_sqe *ts_sqe = io_uring_get_sqe(&loop_->ring_);
         if (ts_sqe)
         {
             io_uring_prep_link_timeout(ts_sqe, &readTimeoutSpec_, 0);
-            io_uring_sqe_set_data(ts_sqe, &timeoutContext_);
+            bindSqe(ts_sqe, timeoutContext_);
         }
         else
         {
-            LOG_ERROR("TcpConnection::submitReadRequestWithUserBuffer: link timeout sqe unavailable");
+            LOG_ERROR("TcpConnection::linkReadTimeout: link timeout sqe unavailable, conn={}", name_);
+        }
+    }
+    else if (deadline != kNoDeadline)
+    {
+        io_uring_sqe *ts_sqe = loop_->linkDeadline(sqe, deadline, &readDeadlineSpec_);
+        if (ts_sqe)
+        {
+            bindSqe(ts_sqe, readDeadlineContext_);
         }
     }
 }
@@ -195,7 +281,7 @@ void TcpConnection::submitWriteRequest()
     // 注意：write 操作不应该修改 outputBuffer_
     // 的可读位置，直到写操作完成(handleWrite)
     io_uring_prep_write(sqe, socket_.getFd(), outputBuffer_.readBeginAddr(), outputBuffer_.readableBytes(), 0);
-    io_uring_sqe_set_data(sqe, &writeContext_);
+    bindSqe(sqe, writeContext_);
     // 标记未使用已注册缓冲区
     writeContext_.idx = -1;
 }
@@ -216,7 +302,7 @@ void TcpConnection::submitWriteRequestWithRegBuffer(void *buf, size_t len, int i
 
     // 使用已注册缓冲区进行写操作（固定缓冲区模式）
     io_uring_prep_write_fixed(sqe, socket_.getFd(), buf, len, 0, idx);
-    io_uring_sqe_set_data(sqe, &writeContext_);
+    bindSqe(sqe, writeContext_);
     // 记录已注册缓冲区索引，写完后由调用者归还
     writeContext_.idx = idx;
 }
@@ -242,7 +328,7 @@ void TcpConnection::submitSendfileRequest(int in_fd, off_t offset, size_t count)
     // （在不支持直接 file->socket splice 的老内核，可能需要通过中间 pipe 缓冲）
     io_uring_prep_splice(sqe, in_fd, offset, socket_.getFd(), -1, count, 0);
 
-    io_uring_sqe_set_data(sqe, &writeContext_);
+    bindSqe(sqe, writeContext_);
     writeContext_.idx = -1; // 标记未使用已注册缓冲区
 }
 
@@ -255,6 +341,417 @@ void TcpConnection::submitWriteRequestWithZeroCopy(const char *data, size_t len,
     }
 }
 
+void TcpConnection::setCorking(bool on)
+{
+    corking_ = on;
+    if (!on)
+    {
+        // 关闭 Cork 时把已合并但未提交的数据立即发出
+        submitOutputWrite();
+    }
+}
+
+bool TcpConnection::submitLinkedRelay(int dstFd, size_t len, std::coroutine_handle<> handle)
+{
+    if (relayInFlight_)
+    {
+        LOG_WARN("TcpConnection::submitLinkedRelay: relay already in flight, name={}", name_);
+        relayResult_ = -EBUSY;
+        return false;
+    }
+    if (!checkConnected())
+    {
+        relayResult_ = -ENOTCONN;
+        return false;
+    }
+    if (len == 0)
+    {
+        relayResult_ = 0;
+        return false;
+    }
+    // 两段 SQE 必须进入同一次提交才能形成链接，空间不足时直接失败而不是只提交读段
+    if (io_uring_sq_space_left(&loop_->ring_) < 2)
+    {
+        LOG_ERROR("TcpConnection::submitLinkedRelay: SQ full, name={}", name_);
+        relayResult_ = -EAGAIN;
+        return false;
+    }
+
+    // 先准备好缓冲区/管道再取 SQE，避免失败时在 SQ 中留下未初始化的 SQE
+    if (dstFd < 0)
+    {
+        int idx = loop_->getRegisteredBufferIndex();
+        if (idx < 0)
+        {
+            LOG_ERROR("TcpConnection::submitLinkedRelay: no registered buffer available, name={}", name_);
+            relayResult_ = -ENOBUFS;
+            return false;
+        }
+        relayInContext_.idx = idx;
+        len = std::min(len, loop_->getRegisteredBufferSize());
+    }
+    else if (!ensureRelayPipe())
+    {
+        relayResult_ = -EMFILE;
+        return false;
+    }
+
+    relayDstFd_ = dstFd;
+    relayInResult_ = 0;
+    relayOutResult_ = 0;
+    relayWritten_ = 0;
+
+    // 读段：带 IOSQE_IO_LINK，读满 len 后内核才会执行紧随其后的写段
+    struct io_uring_sqe *inSqe = io_uring_get_sqe(&loop_->ring_);
+    if (dstFd < 0)
+    {
+        io_uring_prep_read_fixed(inSqe, socket_.getFd(), loop_->getRegisteredBuffer(relayInContext_.idx), len, 0,
+                                 relayInContext_.idx);
+    }
+    else
+    {
+        io_uring_prep_splice(inSqe, socket_.getFd(), -1, relayPipe_[1], -1, len, SPLICE_F_MOVE);
+    }
+    io_uring_sqe_set_flags(inSqe, IOSQE_IO_LINK);
+    bindSqe(inSqe, relayInContext_);
+
+    // 写段：长度按 len 预先填写，短读时由 handleRelayCompletion 按实际读到的长度补交
+    struct io_uring_sqe *outSqe = io_uring_get_sqe(&loop_->ring_);
+    prepRelayWrite(outSqe, 0, len);
+
+    relayHandle_ = handle;
+    relayInFlight_ = true;
+    relayLinked_ = true;
+    relayCancelled_ = false;
+    relayPending_ = 2;
+    if (dstFd < 0)
+    {
+        // 回显写回本连接，半关闭需要等它写完
+        incrementPendingSpecialWrite();
+    }
+    return true;
+}
+
+void TcpConnection::prepRelayWrite(struct io_uring_sqe *sqe, size_t offset, size_t len)
+{
+    if (relayDstFd_ < 0)
+    {
+        char *buf = static_cast<char *>(loop_->getRegisteredBuffer(relayInContext_.idx));
+        io_uring_prep_write_fixed(sqe, socket_.getFd(), buf + offset, len, 0, relayInContext_.idx);
+    }
+    else
+    {
+        // 管道按先进先出消费，不需要偏移
+        io_uring_prep_splice(sqe, relayPipe_[0], -1, relayDstFd_, -1, len, SPLICE_F_MOVE);
+    }
+    bindSqe(sqe, relayOutContext_);
+}
+
+void TcpConnection::handleRelayCompletion()
+{
+    // 链接的两段各产生一个 CQE，全部到达后再汇总处理
+    if (--relayPending_ > 0)
+    {
+        return;
+    }
+    bool linked = relayLinked_;
+    relayLinked_ = false;
+
+    if (relayInResult_ <= 0)
+    {
+        // EOF 或读失败：链接断开，写段已被取消
+        finishRelay(relayInResult_);
+        return;
+    }
+    size_t readBytes = static_cast<size_t>(relayInResult_);
+    if (relayWritten_ >= readBytes)
+    {
+        finishRelay(relayInResult_);
+        return;
+    }
+
+    if (relayCancelled_)
+    {
+        // 被 when_any 等主动取消：不再补交写段
+        finishRelay(-ECANCELED);
+        return;
+    }
+    // 写段未写完：短读导致链接写段被取消、短写或 EAGAIN 时补交剩余部分，其余错误直接结束
+    bool retry = relayOutResult_ > 0 || relayOutResult_ == -EAGAIN || (linked && relayOutResult_ == -ECANCELED);
+    if (!retry)
+    {
+        LOG_WARN("TcpConnection::handleRelayCompletion write failed, conn={}, res={}", name_, relayOutResult_);
+        finishRelay(relayOutResult_ < 0 ? relayOutResult_ : -EIO);
+        return;
+    }
+    if (!checkConnected())
+    {
+        finishRelay(-ENOTCONN);
+        return;
+    }
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&loop_->ring_);
+    if (!sqe)
+    {
+        LOG_ERROR("TcpConnection::handleRelayCompletion: SQ full, conn={}", name_);
+        finishRelay(-EAGAIN);
+        return;
+    }
+    prepRelayWrite(sqe, relayWritten_, readBytes - relayWritten_);
+    relayPending_ = 1;
+}
+
+void TcpConnection::finishRelay(int res)
+{
+    // 保护 TcpConnection，防止在恢复协程的过程中被销毁
+    std::shared_ptr<TcpConnection> guard(shared_from_this());
+    relayInFlight_ = false;
+    relayResult_ = res;
+    if (relayDstFd_ < 0)
+    {
+        loop_->returnRegisteredBuffer(relayInContext_.idx);
+        relayInContext_.idx = -1;
+        decrementPendingSpecialWrite();
+        maybeShutdownWrite();
+    }
+    else if (res < 0)
+    {
+        // 失败时管道中可能残留未转发的数据，重建管道以免混入下一次中继
+        closeRelayPipe();
+    }
+
+    // 恢复操作放在最后：协程可能立即发起下一次中继
+    std::coroutine_handle<> handle = relayHandle_;
+    relayHandle_ = nullptr;
+    if (handle)
+    {
+        handle.resume();
+    }
+}
+
+bool TcpConnection::ensureRelayPipe()
+{
+    if (relayPipe_[0] >= 0)
+    {
+        return true;
+    }
+    if (::pipe2(relayPipe_, O_CLOEXEC) < 0)
+    {
+        LOG_ERROR("TcpConnection::ensureRelayPipe: pipe2 failed, conn={}, errno={}", name_, errno);
+        relayPipe_[0] = relayPipe_[1] = -1;
+        return false;
+    }
+    return true;
+}
+
+void TcpConnection::closeRelayPipe()
+{
+    for (int &fd : relayPipe_)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+void TcpConnection::flush()
+{
+    submitOutputWrite();
+}
+
+void TcpConnection::scheduleFlush()
+{
+    if (flushScheduled_)
+    {
+        return;
+    }
+    flushScheduled_ = true;
+    // 批处理结束回调与本轮 IO 同属一个 Loop 线程，持有 shared_ptr 保证回调执行时连接仍然存活
+    loop_->runAfterBatch([self = shared_from_this()]() {
+        self->flushScheduled_ = false;
+        self->submitOutputWrite();
+        if (!self->isOutputWritePending() && !self->isConnected() && !self->isDisconnecting())
+        {
+            // 等待重试期间连接已断开：写请求不会再提交，让等待者带错误恢复，不再悬挂
+            self->resumeOutputWaiters(-ENOTCONN, true);
+        }
+    });
+}
+
+void TcpConnection::submitOutputWrite()
+{
+    // 同一时刻最多一个写请求在途，在途期间追加的数据等它完成后合并提交，天然保证多个发送协程之间的顺序
+    if (outputWriteInFlight_)
+    {
+        return;
+    }
+    if (flushingBuffer_.readableBytes() == 0)
+    {
+        if (outputBuffer_.readableBytes() == 0)
+        {
+            return;
+        }
+        // 把积压数据整体交换到 flushingBuffer_，之后的 asyncSend 追加到空的 outputBuffer_，
+        // 不会触发 flushingBuffer_ 扩容或搬移，保证内核读取的内存地址在写完成前始终有效
+        flushingBuffer_.reset();
+        flushingBuffer_.swap(outputBuffer_);
+    }
+    if (!isConnected() && !isDisconnecting())
+    {
+        LOG_WARN("TcpConnection::submitOutputWrite: invalid state, name={}", name_);
+        return;
+    }
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&loop_->ring_);
+    if (!sqe)
+    {
+        // SQ 满：先把已有的请求提交出去腾出空间
+        io_uring_submit(&loop_->ring_);
+        sqe = io_uring_get_sqe(&loop_->ring_);
+    }
+    if (!sqe)
+    {
+        // 仍然没有空间：数据保留在缓冲区中，下一轮批处理结束时重试。不能等下一次 asyncSend/flush，
+        // 等待者挂起后可能不会再有新的发送；主动唤醒一次 Loop，保证下一轮循环一定会到来
+        LOG_ERROR("TcpConnection::submitOutputWrite: SQ full, retry after batch, name={}", name_);
+        scheduleFlush();
+        loop_->wakeup();
+        return;
+    }
+    io_uring_prep_write(sqe, socket_.getFd(), flushingBuffer_.readBeginAddr(), flushingBuffer_.readableBytes(), 0);
+    bindSqe(sqe, outputContext_);
+    outputWriteInFlight_ = true;
+
+    // 有等待者设置了截止时间时，按最早的一个链接 LINK_TIMEOUT，到期后写请求被取消，由 handleOutputWrite 处理
+    outputWriteDeadline_ = earliestOutputDeadline();
+    if (outputWriteDeadline_ != kNoDeadline)
+    {
+        io_uring_sqe *ts_sqe = loop_->linkDeadline(sqe, outputWriteDeadline_, &outputDeadlineSpec_);
+        if (ts_sqe)
+        {
+            bindSqe(ts_sqe, outputDeadlineContext_);
+        }
+        else
+        {
+            outputWriteDeadline_ = kNoDeadline;
+        }
+    }
+}
+
+Deadline TcpConnection::earliestOutputDeadline() const
+{
+    Deadline earliest = kNoDeadline;
+    for (const OutputWaiter &waiter : outputWaiters_)
+    {
+        earliest = std::min(earliest, waiter.deadline);
+    }
+    return earliest;
+}
+
+void TcpConnection::handleOutputWrite(int res)
+{
+    // 保护 TcpConnection，防止在恢复等待协程的过程中被销毁
+    std::shared_ptr<TcpConnection> guard(shared_from_this());
+    outputWriteInFlight_ = false;
+    bool timed = outputWriteDeadline_ != kNoDeadline;
+    outputWriteDeadline_ = kNoDeadline;
+
+    bool failed = false;
+    bool resubmit = false;
+    if (res > 0)
+    {
+        flushingBuffer_.retrieve(res);
+        bytesWritten_ += res;
+        // 继续发送未写完的部分，以及在途期间新合并进 outputBuffer_ 的数据
+        submitOutputWrite();
+    }
+    else if (res == -EAGAIN)
+    {
+        submitOutputWrite();
+    }
+    else if (res == -ECANCELED && timed && !drainAborted_ && (isConnected() || isDisconnecting()))
+    {
+        // 链接的截止时间到期，或为了更早的截止时间被主动取消：先让到期的等待者恢复，
+        // 数据仍留在缓冲区中，按剩余等待者的截止时间重新提交
+        resubmit = true;
+    }
+    else
+    {
+        failed = true;
+        LOG_WARN("TcpConnection::handleOutputWrite failed, conn={}, res={}", name_, res);
+    }
+
+    // 写完后检查是否需要执行延迟的半关闭
+    maybeShutdownWrite();
+
+    resumeOutputWaiters(res, failed);
+    if (resubmit)
+    {
+        submitOutputWrite();
+    }
+}
+
+void TcpConnection::resumeOutputWaiters(int res, bool failed)
+{
+    if (outputWaiters_.empty())
+    {
+        return;
+    }
+    // 先摘出本次需要恢复的等待者再逐个恢复：被恢复的协程可能立即再次发送并登记新的等待，
+    // 新等待者必须等下一次写完成再判断，不能被本次（可能是失败的）结果误唤醒
+    readyWaiters_.clear();
+    size_t keep = 0;
+    for (size_t i = 0; i < outputWaiters_.size(); ++i)
+    {
+        OutputWaiter &waiter = outputWaiters_[i];
+        bool expired = false;
+        if (!failed && bytesWritten_ < waiter.target && waiter.deadline != kNoDeadline)
+        {
+            // 直接读精确时钟：COARSE 快照可能落后于已按精确时钟到期的 LINK_TIMEOUT，
+            // 误判为未到期会按同一个已过去的截止时间反复重新提交、立即被取消
+            expired = deadlineExpired(waiter.deadline);
+        }
+        if (failed || bytesWritten_ >= waiter.target || expired)
+        {
+            *waiter.result = expired ? kDeadlineExceeded : res;
+            readyWaiters_.push_back(waiter);
+        }
+        else
+        {
+            outputWaiters_[keep++] = waiter;
+        }
+    }
+    outputWaiters_.resize(keep);
+
+    // 按登记顺序恢复
+    for (size_t i = 0; i < readyWaiters_.size(); ++i)
+    {
+        readyWaiters_[i].handle.resume();
+    }
+    readyWaiters_.clear();
+}
+
+void TcpConnection::waitOutputWritten(std::coroutine_handle<> handle, uint64_t target, int *result, Deadline deadline)
+{
+    outputWaiters_.push_back(OutputWaiter{handle, target, result, deadline});
+    if (outputWriteInFlight_ && deadline < outputWriteDeadline_)
+    {
+        // 在途写请求没有链接（或链接了更晚的）截止时间：取消后由 handleOutputWrite 按最早的截止时间重新提交
+        outputWriteDeadline_ = deadline;
+        loop_->cancelIo(&outputContext_);
+    }
+}
+
+void TcpConnection::removeOutputWaiter(int *result)
+{
+    auto it = std::find_if(outputWaiters_.begin(), outputWaiters_.end(),
+                           [result](const OutputWaiter &waiter) { return waiter.result == result; });
+    if (it != outputWaiters_.end())
+    {
+        outputWaiters_.erase(it);
+    }
+}
+
 void TcpConnection::setTimeout(std::chrono::milliseconds timeout)
 {
     readTimeout_ = timeout;
@@ -290,6 +787,30 @@ void TcpConnection::handleClose()
     }
 }
 
+bool TcpConnection::beginDrain()
+{
+    draining_.store(true, std::memory_order_release);
+    // 空闲读：没有读了一半的请求，也没有待发送的响应，取消读不会打断任何请求
+    if (awaitingRequest_ && readContext_.inflight > 0 && pendingOutputBytes() == 0)
+    {
+        LOG_INFO("TcpConnection::beginDrain cancel idle read, conn={}", name_);
+        loop_->cancelIo(&readContext_);
+        return true;
+    }
+    return false;
+}
+
+void TcpConnection::abortDrain()
+{
+    LOG_INFO("TcpConnection::abortDrain cancel inflight io, conn={}", name_);
+    drainAborted_ = true;
+    // 中继需要先标记取消，否则读段被取消后会补交写段
+    cancelLinkedRelay();
+    cancelInflightIo();
+    // 直接走关闭流程：即使业务协程挂起在 IO 之外（如计算线程池），连接也会从服务器中移除
+    handleClose();
+}
+
 void TcpConnection::releaseCurReadBuffer()
 {
     if (readContext_.idx >= 0)
@@ -311,6 +832,29 @@ void TcpConnection::connectEstablished()
     readContext_.connection = shared_from_this();
     writeContext_.connection = shared_from_this();
     timeoutContext_.connection = shared_from_this();
+    outputContext_.connection = shared_from_this();
+    readDeadlineContext_.connection = shared_from_this();
+    outputDeadlineContext_.connection = shared_from_this();
+    // CQE 分发前已经检查过 connection 是否存活，这里捕获 this 即可，避免 shared_ptr 循环引用
+    outputContext_.handler = [this](int res) { handleOutputWrite(res); };
+    relayInContext_.connection = shared_from_this();
+    relayOutContext_.connection = shared_from_this();
+    relayInContext_.handler = [this](int res) {
+        relayInResult_ = res;
+        if (res > 0)
+        {
+            markActive();
+        }
+        handleRelayCompletion();
+    };
+    relayOutContext_.handler = [this](int res) {
+        relayOutResult_ = res;
+        if (res > 0)
+        {
+            relayWritten_ += res;
+        }
+        handleRelayCompletion();
+    };
     // 修复循环引用：使用 weak_ptr 而不是直接捕获 shared_ptr
     timeoutContext_.handler = [weak_self = std::weak_ptr<TcpConnection>(shared_from_this())](int res) {
         LOG_INFO("Timeout handler called, res={}", res);
@@ -334,6 +878,14 @@ void TcpConnection::connectEstablished()
         self->forceClose(); // 说明发生超时，强制关闭连接
     };
 
+    // 时间轮模式的空闲超时：登记到所属 Loop 的时间轮，读路径只需刷新活跃 tick
+    if (idleTimeout_ > std::chrono::milliseconds::zero())
+    {
+        idleTimingWheel_ = &loop_->getIdleTimingWheel();
+        markActive();
+        idleTimingWheel_->add(shared_from_this(), idleTimeout_);
+    }
+
     // 这里调用 connectionCallback_
     if (connectionCallback_)
     {
@@ -355,6 +907,7 @@ void TcpConnection::connectDestroyed()
     // 否则如果还有其他地方（比如 io_uring 的 IoContext）持有 shared_ptr，
     // Socket 的析构函数就不会被调用，fd 就不会被关闭，连接也就一直挂着。
     socket_.closeFd();
+    closeRelayPipe();
     LOG_INFO("TcpConnection::connectDestroyed fd closed, conn={}", name_);
 
     // io_uring 中挂起的请求会因为 fd 关闭而以 -ECANCELED 或 -EBADF 失败。
@@ -370,7 +923,7 @@ void TcpConnection::connectDestroyed()
 // 目的：防止慢接收客户端导致服务端发送缓冲区无限膨胀，最终 OOM
 void TcpConnection::checkOutputBufferBackpressure(size_t incomingBytes)
 {
-    size_t currentSize = outputBuffer_.readableBytes();
+    size_t currentSize = pendingOutputBytes();
     size_t newSize = currentSize + incomingBytes;
 
     // 统计：记录缓冲区达到的最大峰值，便于后续调优
@@ -0,0 +1,169 @@
+#include "TcpConnectionPool.hpp"
+
+#include "EventLoop.hpp"
+#include "InetAddress.hpp"
+#include "Logger.hpp"
+#include "PoolAllocator.hpp"
+#include "TcpConnection.hpp"
+
+TcpConnectionPool::TcpConnectionPool(EventLoop *loop, size_t capacity) : loop_(loop), capacity_(capacity)
+{
+}
+
+TcpConnectionPool::~TcpConnectionPool()
+{
+    detach();
+}
+
+std::shared_ptr<TcpConnection> TcpConnectionPool::acquire(const std::string &name, int sockfd,
+                                                          const InetAddress &peerAddr)
+{
+    TcpConnection *conn = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty())
+        {
+            conn = free_.back();
+            free_.pop_back();
+            ++stats_.reused;
+        }
+        else
+        {
+            ++stats_.created;
+        }
+    }
+
+    if (conn)
+    {
+        conn->reinit(name, loop_, sockfd, peerAddr);
+    }
+    else
+    {
+        conn = new TcpConnection(name, loop_, sockfd, peerAddr);
+    }
+    return std::shared_ptr<TcpConnection>(conn, Recycler{shared_from_this()}, PoolAllocator<TcpConnection>());
+}
+
+void TcpConnectionPool::Recycler::operator()(TcpConnection *conn) const
+{
+    if (pool->detached_.load())
+    {
+        delete conn;
+        return;
+    }
+    // 最后一个引用可能在任意线程释放（如主 Loop 的连接表），回收统一交给所属 Loop 线程
+    EventLoop *loop = pool->loop_;
+    if (loop->isInLoopThread())
+    {
+        pool->release(conn);
+    }
+    else
+    {
+        // 不能因任务队列满而丢弃：对象既未回收也未释放就会泄漏，队列满时转入溢出链表
+        loop->queueInLoopOrOverflow([pool = pool, conn]() { pool->release(conn); });
+    }
+}
+
+void TcpConnectionPool::release(TcpConnection *conn)
+{
+    if (detached_.load())
+    {
+        delete conn;
+        return;
+    }
+    if (conn->hasInflightIo())
+    {
+        // 仍有请求以该对象的 IoContext 为 user_data，先取消，等 CQE 全部到达后再回收
+        conn->cancelInflightIo();
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.deferred;
+    }
+    // 最后一个引用常常在该对象自己的 IoContext 回调中释放（如回调内的 guard），此时不能立即 reset 掉正在执行的
+    // handler，统一放到本轮批处理结束后回收
+    retiring_.push_back(conn);
+    scheduleReap();
+}
+
+void TcpConnectionPool::recycle(TcpConnection *conn)
+{
+    conn->reset();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() < capacity_)
+        {
+            free_.push_back(conn);
+            ++stats_.recycled;
+            return;
+        }
+        ++stats_.dropped;
+    }
+    delete conn;
+}
+
+void TcpConnectionPool::scheduleReap()
+{
+    if (reapScheduled_)
+    {
+        return;
+    }
+    reapScheduled_ = true;
+    // 取消产生的 CQE 会在后续批次中到达，每轮批处理结束时检查一次即可
+    loop_->runAfterBatch([self = shared_from_this()]() { self->reapRetiring(); });
+}
+
+void TcpConnectionPool::reapRetiring()
+{
+    reapScheduled_ = false;
+    if (detached_.load())
+    {
+        return;
+    }
+    size_t keep = 0;
+    for (size_t i = 0; i < retiring_.size(); ++i)
+    {
+        TcpConnection *conn = retiring_[i];
+        if (conn->hasInflightIo())
+        {
+            retiring_[keep++] = conn;
+        }
+        else
+        {
+            recycle(conn);
+        }
+    }
+    retiring_.resize(keep);
+    if (!retiring_.empty())
+    {
+        scheduleReap();
+    }
+}
+
+void TcpConnectionPool::detach()
+{
+    if (detached_.exchange(true))
+    {
+        return;
+    }
+    std::vector<TcpConnection *> cached;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cached.swap(free_);
+    }
+    for (TcpConnection *conn : cached)
+    {
+        delete conn;
+    }
+    for (TcpConnection *conn : retiring_)
+    {
+        delete conn;
+    }
+    retiring_.clear();
+}
+
+TcpConnectionPool::Stats TcpConnectionPool::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.cached = free_.size();
+    return stats;
+}
@@ -1,7 +1,14 @@
 #include "TcpServer.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
 #include <iostream>
 #include <thread>
+#include <unistd.h>
+
+#include "Logger.hpp"
+#include "TcpConnectionPool.hpp"
 
 TcpServer::TcpServer(EventLoop *loop, const InetAddress &listenAddr, const std::string &name)
     : loop_(loop), name_(name), ipPort_(listenAddr.toIpPort()), acceptor_(new Acceptor(loop, listenAddr, true)),
@@ -10,6 +17,7 @@ TcpServer::TcpServer(EventLoop *loop, const InetAddress &listenAddr, const std::
     // 设置新连接到来的回调函数,传递给Acceptor对象调用
     acceptor_->setNewConnectionCallback(
         std::bind(&TcpServer::newConnection, this, std::placeholders::_1, std::placeholders::_2));
+    drainTimerContext_.handler = std::bind(&TcpServer::handleDrainTimeout, this, std::placeholders::_1);
 }
 
 TcpServer::~TcpServer()
@@ -47,21 +55,38 @@ void TcpServer::setThreadNum(int numThreads)
 
 void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr)
 {
+    if (drainPhase_ != DrainPhase::kNone)
+    {
+        // 停止监听之前已经完成的 accept：不再接收新连接
+        ::close(sockfd);
+        return;
+    }
     // 选择一个 EventLoop 来处理新连接
     EventLoop *ioLoop = threadPool_.getNextLoop();
     // 生成连接名称，连接名称格式为：服务器名称-服务器IP:端口#连接ID，例如
     // MyServer-192.168.1.1:8080#1
-    char buf[32];
-    snprintf(buf, sizeof buf, "-%s#%d", ipPort_.c_str(), nextConnId_++);
-    std::string connName = name_ + buf;
+    char idBuf[16];
+    auto idEnd = std::to_chars(idBuf, idBuf + sizeof idBuf, nextConnId_++).ptr;
+    std::string connName;
+    connName.reserve(name_.size() + ipPort_.size() + 2 + (idEnd - idBuf));
+    connName.append(name_).append("-").append(ipPort_).append("#").append(idBuf, idEnd);
 
-    // 创建 TcpConnection 对象，使用 shared_ptr 管理生命周期
-    auto conn = std::make_shared<TcpConnection>(connName, ioLoop, sockfd, peerAddr);
+    // 从所属 Loop 的对象池取出 TcpConnection 对象（优先复用已关闭连接的对象），仍使用 shared_ptr 管理生命周期
+    auto conn = ioLoop->getConnectionPool().acquire(connName, sockfd, peerAddr);
     // 设置业务逻辑回调函数
     conn->setConnectionCallback(connectionCallback_);
     // 设置关闭连接时的回调函数
     conn->setCloseCallback(std::bind(&TcpServer::removeConnection, this, std::placeholders::_1));
-    conn->setTimeout(readTimeout_); // 设置读超时，清除空闲死连接（僵尸连接）
+    // 设置读超时，清除空闲死连接（僵尸连接）
+    if (idleTimeoutMode_ == IdleTimeoutMode::kTimingWheel)
+    {
+        conn->setIdleTimeout(readTimeout_);
+    }
+    else
+    {
+        conn->setTimeout(readTimeout_);
+    }
+    conn->setCorking(writeCorking_); // 流水线场景下合并同一轮的多次 asyncSend
 
     // 保存连接到活动连接列表
     connections_[connName] = conn;
@@ -79,5 +104,111 @@ void TcpServer::removeConnection(const std::shared_ptr<TcpConnection> &conn)
         // 在连接所属的 EventLoop 线程中销毁连接
         EventLoop *ioLoop = conn->getLoop();
         ioLoop->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
+        if (!connections_.empty())
+        {
+            return;
+        }
+        if (drainPhase_ == DrainPhase::kDraining)
+        {
+            // 截止时间之前全部关闭：取消定时器，在它的 CQE 到达后完成（之后不再有以本对象为 user_data 的请求）
+            loop_->cancelIo(&drainTimerContext_);
+        }
+        else if (drainPhase_ == DrainPhase::kAborting)
+        {
+            finishDrain();
+        }
     });
 }
+
+void TcpServer::drain(std::chrono::milliseconds timeout, DrainCallback cb)
+{
+    loop_->runInLoop([this, timeout, cb = std::move(cb)]() mutable { startDrain(timeout, std::move(cb)); });
+}
+
+void TcpServer::startDrain(std::chrono::milliseconds timeout, DrainCallback cb)
+{
+    if (drainPhase_ != DrainPhase::kNone)
+    {
+        LOG_WARN("TcpServer::drain already started, server={}", name_);
+        return;
+    }
+    drainPhase_ = DrainPhase::kDraining;
+    drainCallback_ = std::move(cb);
+    drainStart_ = std::chrono::steady_clock::now();
+    drainStats_ = DrainStats();
+    drainStats_.total = connections_.size();
+    LOG_INFO("TcpServer::drain start, server={}, connections={}, timeout_ms={}", name_, drainStats_.total,
+             timeout.count());
+
+    acceptor_->stop();
+    if (connections_.empty())
+    {
+        finishDrain();
+        return;
+    }
+    for (auto &pair : connections_)
+    {
+        const std::shared_ptr<TcpConnection> &conn = pair.second;
+        conn->getLoop()->runInLoop([this, conn]() {
+            if (conn->beginDrain())
+            {
+                drainIdleClosed_.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&loop_->ring_);
+    if (!sqe)
+    {
+        LOG_ERROR("TcpServer::drain: SQ full, cancel connections now, server={}", name_);
+        handleDrainTimeout(-EBUSY);
+        return;
+    }
+    drainTimeoutSpec_.tv_sec = timeout.count() / 1000;
+    drainTimeoutSpec_.tv_nsec = (timeout.count() % 1000) * 1000000;
+    io_uring_prep_timeout(sqe, &drainTimeoutSpec_, 0, 0);
+    io_uring_sqe_set_data(sqe, &drainTimerContext_);
+}
+
+void TcpServer::handleDrainTimeout(int res)
+{
+    if (drainPhase_ != DrainPhase::kDraining)
+    {
+        return;
+    }
+    if (connections_.empty())
+    {
+        // 定时器被取消（全部连接已在截止时间前关闭），或到期与最后一个连接的移除同时发生
+        finishDrain();
+        return;
+    }
+    drainPhase_ = DrainPhase::kAborting;
+    drainStats_.cancelled = connections_.size();
+    LOG_WARN("TcpServer::drain deadline reached, server={}, res={}, cancelling {} connections", name_, res,
+             drainStats_.cancelled);
+    for (auto &pair : connections_)
+    {
+        const std::shared_ptr<TcpConnection> &conn = pair.second;
+        conn->getLoop()->runInLoop(std::bind(&TcpConnection::abortDrain, conn));
+    }
+}
+
+void TcpServer::finishDrain()
+{
+    drainPhase_ = DrainPhase::kDone;
+    // 被取消空闲读、但协程没有在截止时间前关闭连接的，计入 cancelled
+    size_t closedInTime = drainStats_.total - drainStats_.cancelled;
+    drainStats_.idleClosed = std::min(drainIdleClosed_.load(std::memory_order_relaxed), closedInTime);
+    drainStats_.drained = closedInTime - drainStats_.idleClosed;
+    drainStats_.elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - drainStart_);
+    LOG_INFO("TcpServer::drain done, server={}, total={}, idle_closed={}, drained={}, cancelled={}, elapsed_ms={}",
+             name_, drainStats_.total, drainStats_.idleClosed, drainStats_.drained, drainStats_.cancelled,
+             drainStats_.elapsed.count());
+    DrainCallback cb = std::move(drainCallback_);
+    drainCallback_ = nullptr;
+    if (cb)
+    {
+        cb(drainStats_);
+    }
+}
@@ -0,0 +1,411 @@
+#include "TimerQueue.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+
+#include "EventLoop.hpp"
+#include "Logger.hpp"
+
+namespace
+{
+// 位图中 [start, nbits) 内第一个置位的下标，没有时返回 nbits
+size_t findSetFrom(const std::vector<uint64_t> &bits, size_t nbits, size_t start)
+{
+    if (start >= nbits)
+    {
+        return nbits;
+    }
+    size_t w = start / 64;
+    uint64_t word = bits[w] & (~uint64_t(0) << (start % 64));
+    while (true)
+    {
+        if (word)
+        {
+            return w * 64 + static_cast<size_t>(std::countr_zero(word));
+        }
+        if (++w >= bits.size())
+        {
+            return nbits;
+        }
+        word = bits[w];
+    }
+}
+
+// 从 from 之后（不含 from）循环查找下一个置位的槽位，返回距离（1..nbits），没有时返回 0
+// 等于 nbits 表示 from 本身的槽位：其中的定时器属于下一圈
+size_t nextSetDistance(const std::vector<uint64_t> &bits, size_t nbits, size_t from)
+{
+    size_t i = findSetFrom(bits, nbits, from + 1);
+    if (i < nbits)
+    {
+        return i - from;
+    }
+    i = findSetFrom(bits, nbits, 0);
+    if (i <= from)
+    {
+        return i + nbits - from;
+    }
+    return 0;
+}
+} // namespace
+
+TimerQueue::TimerQueue(EventLoop *loop, std::chrono::milliseconds tick)
+    : loop_(loop), tick_(tick), start_(loop->now()), timeoutContext_(IoType::Timeout, -1)
+{
+    if (tick_ <= std::chrono::nanoseconds::zero())
+    {
+        tick_ = std::chrono::milliseconds(1);
+    }
+    for (int i = 0; i < kLevels; ++i)
+    {
+        size_t slots = size_t(1) << kLevelBits[i];
+        // 哨兵自引用，构造后容器不能再扩容
+        levels_[i].slots = std::vector<detail::TimerListHook>(slots);
+        levels_[i].occupied.assign((slots + 63) / 64, 0);
+    }
+    // 时间轮由 EventLoop 持有，生命周期覆盖在途的 timeout，捕获 this 即可
+    timeoutContext_.handler = [this](int res) { handleTimeout(res); };
+}
+
+TimerQueue::~TimerQueue()
+{
+    // 未到期的协程睡眠无法再恢复，随 Loop 一起结束；节点内存随 chunks_ 释放
+    if (size_ > 0)
+    {
+        LOG_WARN("TimerQueue destroyed with {} pending timers", size_);
+    }
+}
+
+TimerId TimerQueue::runAt(Deadline when, Functor cb)
+{
+    return add(when, 0, std::move(cb), nullptr);
+}
+
+TimerId TimerQueue::runAfter(std::chrono::nanoseconds delay, Functor cb)
+{
+    return add(deadlineAfter(delay), 0, std::move(cb), nullptr);
+}
+
+TimerId TimerQueue::runEvery(std::chrono::nanoseconds interval, Functor cb)
+{
+    uint64_t intervalTicks = static_cast<uint64_t>((interval + tick_ - std::chrono::nanoseconds(1)) / tick_);
+    return add(deadlineAfter(interval), std::max<uint64_t>(intervalTicks, 1), std::move(cb),
+               nullptr);
+}
+
+TimerQueue::SleepAwaitable TimerQueue::sleepFor(std::chrono::nanoseconds duration)
+{
+    return SleepAwaitable(this, deadlineAfter(duration));
+}
+
+bool TimerQueue::cancel(TimerId id)
+{
+    TimerNode *node = static_cast<TimerNode *>(id.node);
+    if (!node || node->seq != id.seq)
+    {
+        // 已到期（单次）或已取消，节点可能已被复用
+        return false;
+    }
+    if (node->running)
+    {
+        // 周期定时器在自己的回调中取消：回调返回后释放
+        node->cancelled = true;
+        ++stats_.cancelled;
+        return true;
+    }
+    detach(node);
+    --size_;
+    ++stats_.cancelled;
+    freeNode(node);
+    // 内核 timeout 不撤销，到期时发现没有需要处理的定时器即可（最多一次空唤醒）
+    return true;
+}
+
+TimerId TimerQueue::add(Deadline when, uint64_t intervalTicks, Functor cb, std::coroutine_handle<> handle)
+{
+    if (size_ == 0)
+    {
+        // 空闲期间时间轮没有推进，先对齐到当前时间，让新定时器落在低层槽位
+        currentTick_ = std::max(currentTick_, nowTick());
+    }
+    TimerNode *node = allocNode();
+    node->expire = std::max(toTick(when), currentTick_ + 1);
+    node->interval = intervalTicks;
+    node->cb = std::move(cb);
+    node->handle = handle;
+    place(node);
+    ++size_;
+    ++stats_.added;
+    rearm();
+    return TimerId{node, node->seq};
+}
+
+TimerQueue::TimerNode *TimerQueue::allocNode()
+{
+    if (!freeList_)
+    {
+        chunks_.emplace_back(new TimerNode[kChunkSize]);
+        TimerNode *chunk = chunks_.back().get();
+        for (size_t i = kChunkSize; i > 0; --i)
+        {
+            chunk[i - 1].nextFree = freeList_;
+            freeList_ = &chunk[i - 1];
+        }
+    }
+    TimerNode *node = freeList_;
+    freeList_ = node->nextFree;
+    node->nextFree = nullptr;
+    return node;
+}
+
+void TimerQueue::freeNode(TimerNode *node)
+{
+    ++node->seq;
+    node->cb = nullptr;
+    node->handle = nullptr;
+    node->running = false;
+    node->cancelled = false;
+    node->level = kDetached;
+    node->nextFree = freeList_;
+    freeList_ = node;
+}
+
+void TimerQueue::place(TimerNode *node)
+{
+    uint64_t expire = node->expire;
+    uint64_t delta = expire - currentTick_;
+    if (delta >= kMaxSpan)
+    {
+        // 超出一圈：先放在最高层最远的槽位，降级时按真实到期时间重新放置
+        expire = currentTick_ + kMaxSpan - 1;
+        delta = kMaxSpan - 1;
+    }
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (uint64_t(1) << (kLevelShift[level] + kLevelBits[level])))
+    {
+        ++level;
+    }
+    size_t slot = static_cast<size_t>((expire >> kLevelShift[level]) & ((uint64_t(1) << kLevelBits[level]) - 1));
+    node->level = static_cast<uint8_t>(level);
+    node->slot = static_cast<uint16_t>(slot);
+    levels_[level].slots[slot].pushBack(node);
+    levels_[level].occupied[slot / 64] |= uint64_t(1) << (slot % 64);
+}
+
+void TimerQueue::detach(TimerNode *node)
+{
+    node->unlink();
+    if (node->level == kDetached)
+    {
+        return;
+    }
+    Level &level = levels_[node->level];
+    if (level.slots[node->slot].empty())
+    {
+        level.occupied[node->slot / 64] &= ~(uint64_t(1) << (node->slot % 64));
+    }
+    node->level = kDetached;
+}
+
+uint64_t TimerQueue::nextEventTick() const
+{
+    uint64_t next = kNoTick;
+    for (int i = 0; i < kLevels; ++i)
+    {
+        size_t nslots = size_t(1) << kLevelBits[i];
+        uint64_t base = currentTick_ >> kLevelShift[i];
+        size_t distance = nextSetDistance(levels_[i].occupied, nslots, static_cast<size_t>(base & (nslots - 1)));
+        if (distance > 0)
+        {
+            // 0 层是到期时刻，高层是该槽位的降级时刻（低位全为 0 的 tick）
+            next = std::min(next, (base + distance) << kLevelShift[i]);
+        }
+    }
+    return next;
+}
+
+void TimerQueue::advance(uint64_t target)
+{
+    while (currentTick_ < target)
+    {
+        uint64_t next = nextEventTick();
+        if (next > target)
+        {
+            // 中间的 tick 所有层的槽位都为空，直接跳过
+            currentTick_ = target;
+            break;
+        }
+        currentTick_ = next;
+        // 低位全为 0 说明到达了对应高层槽位的边界，由低到高依次降级
+        for (int i = 1; i < kLevels; ++i)
+        {
+            if ((currentTick_ & ((uint64_t(1) << kLevelShift[i]) - 1)) != 0)
+            {
+                break;
+            }
+            cascade(i, static_cast<size_t>((currentTick_ >> kLevelShift[i]) & ((uint64_t(1) << kLevelBits[i]) - 1)));
+        }
+        expire(static_cast<size_t>(currentTick_ & ((uint64_t(1) << kLevelBits[0]) - 1)));
+    }
+}
+
+void TimerQueue::cascade(int level, size_t slot)
+{
+    detail::TimerListHook pending;
+    detail::TimerListHook &head = levels_[level].slots[slot];
+    while (!head.empty())
+    {
+        TimerNode *node = static_cast<TimerNode *>(head.next);
+        node->unlink();
+        pending.pushBack(node);
+    }
+    levels_[level].occupied[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    while (!pending.empty())
+    {
+        TimerNode *node = static_cast<TimerNode *>(pending.next);
+        node->unlink();
+        place(node);
+        ++stats_.cascaded;
+    }
+}
+
+void TimerQueue::expire(size_t slot)
+{
+    // 先整体摘到临时链表：回调中可能添加落在同一槽位的新定时器，也可能取消本批中尚未执行的定时器
+    detail::TimerListHook expiring;
+    detail::TimerListHook &head = levels_[0].slots[slot];
+    while (!head.empty())
+    {
+        TimerNode *node = static_cast<TimerNode *>(head.next);
+        node->unlink();
+        node->level = kDetached;
+        expiring.pushBack(node);
+    }
+    levels_[0].occupied[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+
+    while (!expiring.empty())
+    {
+        TimerNode *node = static_cast<TimerNode *>(expiring.next);
+        node->unlink();
+        if (node->expire > currentTick_)
+        {
+            // 下一圈才到期
+            place(node);
+            continue;
+        }
+        ++stats_.fired;
+        if (node->interval == 0)
+        {
+            // 单次定时器先释放再执行：回调中对它的 cancel 返回 false，新定时器可以直接复用该节点
+            std::coroutine_handle<> handle = node->handle;
+            Functor cb = std::move(node->cb);
+            --size_;
+            freeNode(node);
+            if (handle)
+            {
+                handle.resume();
+            }
+            else if (cb)
+            {
+                cb();
+            }
+            continue;
+        }
+        node->running = true;
+        node->cb();
+        node->running = false;
+        if (node->cancelled)
+        {
+            --size_;
+            freeNode(node);
+            continue;
+        }
+        node->expire = std::max(node->expire + node->interval, currentTick_ + 1);
+        place(node);
+    }
+}
+
+void TimerQueue::rearm()
+{
+    uint64_t next = nextEventTick();
+    if (next == kNoTick || (armed_ && next >= armedTick_))
+    {
+        return;
+    }
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&loop_->ring_);
+    if (!sqe)
+    {
+        // SQ 满：下一次添加定时器或已武装的 timeout 到期时重试
+        LOG_ERROR("TimerQueue::rearm: SQ full");
+        return;
+    }
+    // steady_clock 即 CLOCK_MONOTONIC，直接使用绝对时间，避免相对时间在提交前的排队延迟中漂移
+    auto when = start_ + tick_ * next;
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count();
+    armSpec_.tv_sec = ns / 1000000000;
+    armSpec_.tv_nsec = ns % 1000000000;
+    if (!armed_)
+    {
+        io_uring_prep_timeout(sqe, &armSpec_, 0, IORING_TIMEOUT_ABS);
+        io_uring_sqe_set_data(sqe, &timeoutContext_);
+        armed_ = true;
+    }
+    else
+    {
+        // 已有 timeout 在途：原地提前到期时间；若它已经到期（CQE 尚未处理），更新以 -ENOENT 失败，到期回调中会重新武装
+        io_uring_prep_timeout_update(sqe, &armSpec_, reinterpret_cast<__u64>(&timeoutContext_), IORING_TIMEOUT_ABS);
+        io_uring_sqe_set_data(sqe, nullptr);
+    }
+    armedTick_ = next;
+    ++stats_.armed;
+}
+
+void TimerQueue::handleTimeout(int res)
+{
+    uint64_t firedTick = armedTick_;
+    armed_ = false;
+    armedTick_ = kNoTick;
+    if (res != -ETIME && res < 0)
+    {
+        // 被取消（如 io_uring 退出）时不再继续
+        LOG_WARN("TimerQueue::handleTimeout: timeout failed, res={}", res);
+        return;
+    }
+    // 内核已按精确时钟到期，而 COARSE 快照可能还落后一个调度 tick：至少推进到武装的 tick，避免立即重新武装空转
+    advance(std::max(nowTick(), firedTick));
+    rearm();
+}
+
+void TimerQueue::SleepAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    handle_ = handle;
+    id_ = queue_->add(when_, 0, nullptr, handle);
+}
+
+void TimerQueue::SleepAwaitable::cancel() noexcept
+{
+    if (queue_->cancel(id_))
+    {
+        // 不在调用方（如 when_any）的栈上直接恢复
+        queue_->loop_->runAfterBatch([handle = handle_]() { handle.resume(); });
+    }
+}
+
+uint64_t TimerQueue::nowTick() const
+{
+    return static_cast<uint64_t>((loop_->now() - start_) / tick_);
+}
+
+uint64_t TimerQueue::toTick(Deadline when) const
+{
+    if (when <= start_)
+    {
+        return 0;
+    }
+    if (when == kNoDeadline)
+    {
+        return kNoTick - 1;
+    }
+    return static_cast<uint64_t>((when - start_ + tick_ - std::chrono::nanoseconds(1)) / tick_);
+}
@@ -150,7 +150,7 @@ std::string buildHttpResponse(std::string_view body, bool keepAlive = true)
 
 // ===================== HTTP Ping-Pong 协程任务 =====================
 // 适合 wrk 等 HTTP 压测工具
-Task httpPingPongTask(std::shared_ptr<TcpConnection> conn)
+DetachedTask httpPingPongTask(std::shared_ptr<TcpConnection> conn)
 {
     try
     {
@@ -290,6 +290,10 @@ int main(int argc, char **argv)
         config.getSizeT("event_loop.registered_buffer_size", loopOptions.registeredBuffersSize);
     loopOptions.pendingQueueCapacity =
         config.getSizeT("event_loop.pending_queue_capacity", loopOptions.pendingQueueCapacity);
+    loopOptions.idleWheelTick = config.getDurationMs("event_loop.idle_wheel_tick_ms", loopOptions.idleWheelTick);
+    loopOptions.idleWheelSlots = config.getSizeT("event_loop.idle_wheel_slots", loopOptions.idleWheelSlots);
+    loopOptions.connectionPoolCapacity =
+        config.getSizeT("event_loop.connection_pool_capacity", loopOptions.connectionPoolCapacity);
 
     EventLoop loop(loopOptions);
     LOG_DEBUG("EventLoop created.");
@@ -331,6 +335,12 @@ int main(int argc, char **argv)
     server.setThreadNum(threadNum);
     server.setEventLoopOptions(loopOptions);
     server.setReadTimeout(config.getDurationMs("server.read_timeout_ms", std::chrono::milliseconds(5000)));
+    // 空闲超时机制：link_timeout（每次读链接一个内核定时器）或 timing_wheel（每个 Loop 一个时间轮批量清理）
+    if (config.getString("server.idle_timeout_mode", "link_timeout") == "timing_wheel")
+    {
+        server.setIdleTimeoutMode(IdleTimeoutMode::kTimingWheel);
+    }
+    server.setWriteCorking(config.getBool("server.write_corking", false));
     LOG_DEBUG("Thread num set to {}. Starting server...", threadNum);
     server.start();
     LOG_INFO("Server started successfully with {} worker threads.", threadNum);